@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeAdjacencySnapshot.h"
+
+int32 FNodeAdjacencySnapshot::GetNumRelationTypes()
+{
+    // 去掉自动生成的_MAX
+    static const int32 NumTypes = StaticEnum<ENodeRelationType>()->NumEnums() - 1;
+    return NumTypes;
+}
+
+void FNodeAdjacencySnapshot::Build(int32 InNumSlots, const TArray<FNodeAdjacencyEdge>& Edges)
+{
+    NumSlots = FMath::Max(InNumSlots, 0);
+    NumEdges = Edges.Num();
+    NumRelationTypes = GetNumRelationTypes();
+
+    BuildList(Lists[static_cast<int32>(ENodeEdgeDirection::Outgoing)], Edges, ENodeEdgeDirection::Outgoing);
+    BuildList(Lists[static_cast<int32>(ENodeEdgeDirection::Incoming)], Edges, ENodeEdgeDirection::Incoming);
+    BuildList(Lists[static_cast<int32>(ENodeEdgeDirection::Undirected)], Edges, ENodeEdgeDirection::Undirected);
+}
+
+void FNodeAdjacencySnapshot::Reset()
+{
+    for (FNodeAdjacencyList& List : Lists)
+    {
+        List.Offsets.Empty();
+        List.Neighbors.Empty();
+        List.Connections.Empty();
+    }
+    NumSlots = 0;
+    NumEdges = 0;
+    BuiltVersion = 0;
+}
+
+FNodeEdgeRange FNodeAdjacencySnapshot::GetEdges(int32 SlotIndex, ENodeEdgeDirection Direction, ENodeRelationType RelationType) const
+{
+    FNodeEdgeRange Range;
+    const int32 Type = static_cast<int32>(RelationType);
+    if (IsValidSlot(SlotIndex) && Type < NumRelationTypes)
+    {
+        const FNodeAdjacencyList& List = GetList(Direction);
+        const int32 Bucket = SlotIndex * NumRelationTypes + Type;
+        Range.Begin = List.Offsets[Bucket];
+        Range.End = List.Offsets[Bucket + 1];
+    }
+    return Range;
+}
+
+FNodeEdgeRange FNodeAdjacencySnapshot::GetAllEdges(int32 SlotIndex, ENodeEdgeDirection Direction) const
+{
+    FNodeEdgeRange Range;
+    if (IsValidSlot(SlotIndex))
+    {
+        const FNodeAdjacencyList& List = GetList(Direction);
+        Range.Begin = List.Offsets[SlotIndex * NumRelationTypes];
+        Range.End = List.Offsets[(SlotIndex + 1) * NumRelationTypes];
+    }
+    return Range;
+}
+
+void FNodeAdjacencySnapshot::BuildList(FNodeAdjacencyList& List, const TArray<FNodeAdjacencyEdge>& Edges, ENodeEdgeDirection Direction)
+{
+    const int32 NumBuckets = NumSlots * NumRelationTypes;
+    const bool bAddForward = Direction != ENodeEdgeDirection::Incoming;
+    const bool bAddBackward = Direction != ENodeEdgeDirection::Outgoing;
+
+    // 每条边按方向展开为 (所属槽位, 邻居槽位)
+    auto ForEachEntry = [bAddForward, bAddBackward](const FNodeAdjacencyEdge& Edge, auto&& Func)
+    {
+        if (bAddForward)
+        {
+            Func(Edge.Source, Edge.Target);
+        }
+        if (bAddBackward)
+        {
+            Func(Edge.Target, Edge.Source);
+        }
+    };
+
+    // 计数
+    List.Offsets.Reset();
+    List.Offsets.SetNumZeroed(NumBuckets + 1);
+    int32 NumEntries = 0;
+    for (const FNodeAdjacencyEdge& Edge : Edges)
+    {
+        const int32 Type = static_cast<int32>(Edge.RelationType);
+        ForEachEntry(Edge, [&](int32 Owner, int32 Neighbor)
+        {
+            List.Offsets[Owner * NumRelationTypes + Type + 1]++;
+            NumEntries++;
+        });
+    }
+
+    // 前缀和
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        List.Offsets[Bucket + 1] += List.Offsets[Bucket];
+    }
+
+    // 填充
+    List.Neighbors.Reset();
+    List.Neighbors.SetNumUninitialized(NumEntries, false);
+    List.Connections.Reset();
+    List.Connections.SetNumUninitialized(NumEntries, false);
+
+    TArray<int32> Cursor(List.Offsets.GetData(), NumBuckets);
+    for (const FNodeAdjacencyEdge& Edge : Edges)
+    {
+        const int32 Type = static_cast<int32>(Edge.RelationType);
+        ForEachEntry(Edge, [&](int32 Owner, int32 Neighbor)
+        {
+            const int32 Entry = Cursor[Owner * NumRelationTypes + Type]++;
+            List.Neighbors[Entry] = Neighbor;
+            List.Connections[Entry] = Edge.Connection;
+        });
+    }
+}
@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeComponentIndex.h"
+
+void FNodeComponentIndex::AddSlot(int32 SlotIndex)
+{
+    if (SlotIndex < 0)
+    {
+        return;
+    }
+
+    // 新增的槽位先标记为未登记
+    while (Parent.Num() <= SlotIndex)
+    {
+        Parent.Add(INDEX_NONE);
+        Size.Add(0);
+    }
+
+    Parent[SlotIndex] = SlotIndex;
+    Size[SlotIndex] = 1;
+    bPartitionsValid = false;
+}
+
+void FNodeComponentIndex::Union(int32 SlotA, int32 SlotB)
+{
+    int32 RootA = Find(SlotA);
+    int32 RootB = Find(SlotB);
+    if (RootA == INDEX_NONE || RootB == INDEX_NONE || RootA == RootB)
+    {
+        return;
+    }
+
+    // 小树挂到大树下
+    if (Size[RootA] < Size[RootB])
+    {
+        Swap(RootA, RootB);
+    }
+    Parent[RootB] = RootA;
+    Size[RootA] += Size[RootB];
+    bPartitionsValid = false;
+}
+
+void FNodeComponentIndex::Rebuild(const FNodeAdjacencySnapshot& Graph, TFunctionRef<bool(int32)> IsSlotUsed)
+{
+    const int32 NumSlots = Graph.GetNumSlots();
+    Parent.Init(INDEX_NONE, NumSlots);
+    Size.Init(0, NumSlots);
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        if (IsSlotUsed(Slot))
+        {
+            Parent[Slot] = Slot;
+            Size[Slot] = 1;
+        }
+    }
+
+    // 每条边只在出边表中出现一次
+    const uint32 AllRelations = FNodeAdjacencySnapshot::GetAllRelationsMask();
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        Graph.ForEachNeighbor(Slot, ENodeEdgeDirection::Outgoing, AllRelations, [this, Slot](int32 Neighbor, ANodeConnection*)
+        {
+            Union(Slot, Neighbor);
+            return true;
+        });
+    }
+
+    bStale = false;
+    bPartitionsValid = false;
+}
+
+void FNodeComponentIndex::Reset()
+{
+    Parent.Empty();
+    Size.Empty();
+    PartitionOffsets.Empty();
+    PartitionSlots.Empty();
+    PartitionOfSlot.Empty();
+    bStale = false;
+    bPartitionsValid = false;
+}
+
+int32 FNodeComponentIndex::Find(int32 SlotIndex) const
+{
+    if (!Parent.IsValidIndex(SlotIndex) || Parent[SlotIndex] == INDEX_NONE)
+    {
+        return INDEX_NONE;
+    }
+
+    while (Parent[SlotIndex] != SlotIndex)
+    {
+        Parent[SlotIndex] = Parent[Parent[SlotIndex]];
+        SlotIndex = Parent[SlotIndex];
+    }
+    return SlotIndex;
+}
+
+bool FNodeComponentIndex::IsConnected(int32 SlotA, int32 SlotB) const
+{
+    const int32 RootA = Find(SlotA);
+    return RootA != INDEX_NONE && RootA == Find(SlotB);
+}
+
+int32 FNodeComponentIndex::GetNumPartitions() const
+{
+    BuildPartitions();
+    return FMath::Max(PartitionOffsets.Num() - 1, 0);
+}
+
+TConstArrayView<int32> FNodeComponentIndex::GetPartition(int32 PartitionIndex) const
+{
+    if (PartitionIndex < 0 || PartitionIndex >= GetNumPartitions())
+    {
+        return TConstArrayView<int32>();
+    }
+
+    const int32 Begin = PartitionOffsets[PartitionIndex];
+    return TConstArrayView<int32>(PartitionSlots.GetData() + Begin, PartitionOffsets[PartitionIndex + 1] - Begin);
+}
+
+int32 FNodeComponentIndex::GetPartitionOfSlot(int32 SlotIndex) const
+{
+    BuildPartitions();
+    return PartitionOfSlot.IsValidIndex(SlotIndex) ? PartitionOfSlot[SlotIndex] : INDEX_NONE;
+}
+
+void FNodeComponentIndex::BuildPartitions() const
+{
+    if (bPartitionsValid)
+    {
+        return;
+    }
+
+    // 代表元 -> 分区下标，按槽位顺序编号
+    const int32 NumSlots = Parent.Num();
+    PartitionOfSlot.Init(INDEX_NONE, NumSlots);
+    TArray<int32> PartitionOfRoot;
+    PartitionOfRoot.Init(INDEX_NONE, NumSlots);
+    TArray<int32> Counts;
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        const int32 Root = Find(Slot);
+        if (Root == INDEX_NONE)
+        {
+            continue;
+        }
+        if (PartitionOfRoot[Root] == INDEX_NONE)
+        {
+            PartitionOfRoot[Root] = Counts.Add(0);
+        }
+        PartitionOfSlot[Slot] = PartitionOfRoot[Root];
+        Counts[PartitionOfRoot[Root]]++;
+    }
+
+    // 计数 -> 前缀和 -> 填充
+    PartitionOffsets.SetNumUninitialized(Counts.Num() + 1);
+    PartitionOffsets[0] = 0;
+    for (int32 Partition = 0; Partition < Counts.Num(); ++Partition)
+    {
+        PartitionOffsets[Partition + 1] = PartitionOffsets[Partition] + Counts[Partition];
+    }
+
+    PartitionSlots.SetNumUninitialized(PartitionOffsets.Last());
+    TArray<int32> Cursor(PartitionOffsets.GetData(), Counts.Num());
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        if (PartitionOfSlot[Slot] != INDEX_NONE)
+        {
+            PartitionSlots[Cursor[PartitionOfSlot[Slot]]++] = Slot;
+        }
+    }
+
+    bPartitionsValid = true;
+}
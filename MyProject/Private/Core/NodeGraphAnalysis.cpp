@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeGraphAnalysis.h"
+
+void FNodeGraphAnalysis::Analyze(const FNodeAdjacencySnapshot& Graph, uint32 RelationMask)
+{
+    Reset();
+
+    const int32 NumSlots = Graph.GetNumSlots();
+
+    // 按掩码过滤出一份紧凑的后继表，DFS游标只需一个整数
+    TArray<int32> SuccessorOffsets;
+    TArray<int32> Successors;
+    TArray<ANodeConnection*> SuccessorConnections;
+    SuccessorOffsets.SetNumUninitialized(NumSlots + 1);
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        SuccessorOffsets[Slot] = Successors.Num();
+        Graph.ForEachNeighbor(Slot, ENodeEdgeDirection::Outgoing, RelationMask, [&](int32 Neighbor, ANodeConnection* Connection)
+        {
+            Successors.Add(Neighbor);
+            SuccessorConnections.Add(Connection);
+            return true;
+        });
+    }
+    SuccessorOffsets[NumSlots] = Successors.Num();
+
+    // Tarjan：分量按逆拓扑序产出
+    TArray<int32> DiscoveryIndex;
+    TArray<int32> LowLink;
+    DiscoveryIndex.Init(INDEX_NONE, NumSlots);
+    LowLink.Init(0, NumSlots);
+    TBitArray<> OnStack(false, NumSlots);
+    TBitArray<> OnPath(false, NumSlots);
+    TArray<int32> Stack;
+
+    struct FFrame
+    {
+        int32 Slot;
+        int32 Cursor;
+    };
+    TArray<FFrame> CallStack;
+
+    ComponentOfSlot.Init(INDEX_NONE, NumSlots);
+    ComponentSlots.Reserve(NumSlots);
+    TArray<int32> ReverseOffsets;
+    int32 NextIndex = 0;
+
+    for (int32 Root = 0; Root < NumSlots; ++Root)
+    {
+        if (DiscoveryIndex[Root] != INDEX_NONE)
+        {
+            continue;
+        }
+
+        auto Enter = [&](int32 Slot)
+        {
+            DiscoveryIndex[Slot] = LowLink[Slot] = NextIndex++;
+            Stack.Add(Slot);
+            OnStack[Slot] = true;
+            OnPath[Slot] = true;
+            CallStack.Add(FFrame{ Slot, SuccessorOffsets[Slot] });
+        };
+        Enter(Root);
+
+        while (CallStack.Num() > 0)
+        {
+            FFrame& Frame = CallStack.Last();
+            const int32 Slot = Frame.Slot;
+
+            if (Frame.Cursor < SuccessorOffsets[Slot + 1])
+            {
+                const int32 Edge = Frame.Cursor++;
+                const int32 Next = Successors[Edge];
+                if (DiscoveryIndex[Next] == INDEX_NONE)
+                {
+                    // Enter会使Frame引用失效，之后不再使用
+                    Enter(Next);
+                }
+                else
+                {
+                    if (OnPath[Next])
+                    {
+                        CycleEdges.Add(SuccessorConnections[Edge]);
+                    }
+                    if (OnStack[Next])
+                    {
+                        LowLink[Slot] = FMath::Min(LowLink[Slot], DiscoveryIndex[Next]);
+                    }
+                }
+                continue;
+            }
+
+            // 所有后继处理完毕，回溯
+            CallStack.Pop(false);
+            OnPath[Slot] = false;
+            if (CallStack.Num() > 0)
+            {
+                const int32 Caller = CallStack.Last().Slot;
+                LowLink[Caller] = FMath::Min(LowLink[Caller], LowLink[Slot]);
+            }
+
+            if (LowLink[Slot] == DiscoveryIndex[Slot])
+            {
+                ReverseOffsets.Add(ComponentSlots.Num());
+                int32 Member;
+                do
+                {
+                    Member = Stack.Pop(false);
+                    OnStack[Member] = false;
+                    ComponentSlots.Add(Member);
+                }
+                while (Member != Slot);
+            }
+        }
+    }
+    ReverseOffsets.Add(ComponentSlots.Num());
+
+    // 翻转为拓扑序：分量顺序翻转，分量内部顺序保持
+    const int32 NumComponents = ReverseOffsets.Num() - 1;
+    TArray<int32> OrderedSlots;
+    OrderedSlots.Reserve(ComponentSlots.Num());
+    ComponentOffsets.Reserve(NumComponents + 1);
+    for (int32 Reverse = NumComponents - 1; Reverse >= 0; --Reverse)
+    {
+        const int32 Component = ComponentOffsets.Add(OrderedSlots.Num());
+        for (int32 Position = ReverseOffsets[Reverse]; Position < ReverseOffsets[Reverse + 1]; ++Position)
+        {
+            ComponentOfSlot[ComponentSlots[Position]] = Component;
+            OrderedSlots.Add(ComponentSlots[Position]);
+        }
+    }
+    ComponentOffsets.Add(OrderedSlots.Num());
+    ComponentSlots = MoveTemp(OrderedSlots);
+
+    // 按拓扑序松弛层级，并标记含环分量
+    TArray<int32> ComponentRanks;
+    ComponentRanks.Init(0, NumComponents);
+    for (int32 Component = 0; Component < NumComponents; ++Component)
+    {
+        bool bCyclic = ComponentOffsets[Component + 1] - ComponentOffsets[Component] > 1;
+        for (int32 Slot : GetComponent(Component))
+        {
+            for (int32 Edge = SuccessorOffsets[Slot]; Edge < SuccessorOffsets[Slot + 1]; ++Edge)
+            {
+                const int32 NextComponent = ComponentOfSlot[Successors[Edge]];
+                if (NextComponent == Component)
+                {
+                    bCyclic = true;
+                }
+                else
+                {
+                    ComponentRanks[NextComponent] = FMath::Max(ComponentRanks[NextComponent], ComponentRanks[Component] + 1);
+                }
+            }
+        }
+
+        if (bCyclic)
+        {
+            CyclicComponents.Add(Component);
+        }
+    }
+
+    UnlockRanks.SetNumUninitialized(NumSlots);
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        UnlockRanks[Slot] = ComponentRanks[ComponentOfSlot[Slot]];
+    }
+
+    AnalyzedVersion = Graph.BuiltVersion;
+}
+
+void FNodeGraphAnalysis::Reset()
+{
+    ComponentOfSlot.Reset();
+    ComponentOffsets.Reset();
+    ComponentSlots.Reset();
+    UnlockRanks.Reset();
+    CyclicComponents.Reset();
+    CycleEdges.Reset();
+    AnalyzedVersion = 0;
+}
+
+TConstArrayView<int32> FNodeGraphAnalysis::GetComponent(int32 ComponentIndex) const
+{
+    if (ComponentIndex < 0 || ComponentIndex >= GetNumComponents())
+    {
+        return TConstArrayView<int32>();
+    }
+
+    const int32 Begin = ComponentOffsets[ComponentIndex];
+    return TConstArrayView<int32>(ComponentSlots.GetData() + Begin, ComponentOffsets[ComponentIndex + 1] - Begin);
+}
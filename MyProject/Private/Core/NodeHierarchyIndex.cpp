@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeHierarchyIndex.h"
+
+void FNodeHierarchyIndex::SetSceneParent(int32 SlotIndex, int32 SceneSlot)
+{
+    if (SlotIndex < 0)
+    {
+        return;
+    }
+
+    FEntry& Entry = GetOrAddEntry(SlotIndex);
+    if (Entry.SceneParent != SceneSlot)
+    {
+        Entry.SceneParent = SceneSlot;
+        ResolveParent(SlotIndex);
+    }
+}
+
+void FNodeHierarchyIndex::AddLinkParent(int32 SlotIndex, int32 ParentSlot)
+{
+    if (SlotIndex < 0 || ParentSlot < 0)
+    {
+        return;
+    }
+
+    GetOrAddEntry(SlotIndex).LinkParents.Add(ParentSlot);
+    ResolveParent(SlotIndex);
+}
+
+void FNodeHierarchyIndex::RemoveLinkParent(int32 SlotIndex, int32 ParentSlot)
+{
+    if (!Entries.IsValidIndex(SlotIndex))
+    {
+        return;
+    }
+
+    if (Entries[SlotIndex].LinkParents.RemoveSingle(ParentSlot) > 0)
+    {
+        ResolveParent(SlotIndex);
+    }
+}
+
+void FNodeHierarchyIndex::RemoveNode(int32 SlotIndex)
+{
+    if (!Entries.IsValidIndex(SlotIndex))
+    {
+        return;
+    }
+
+    // 子节点不再以该节点为候选父节点
+    const TArray<int32> Children = Entries[SlotIndex].Children;
+    for (int32 Child : Children)
+    {
+        FEntry& ChildEntry = Entries[Child];
+        if (ChildEntry.SceneParent == SlotIndex)
+        {
+            ChildEntry.SceneParent = INDEX_NONE;
+        }
+        ChildEntry.LinkParents.Remove(SlotIndex);
+        ResolveParent(Child);
+    }
+
+    FEntry& Entry = Entries[SlotIndex];
+    Entry.SceneParent = INDEX_NONE;
+    Entry.LinkParents.Reset();
+    Reparent(SlotIndex, INDEX_NONE);
+
+    Entries[SlotIndex] = FEntry();
+}
+
+void FNodeHierarchyIndex::Reset()
+{
+    Entries.Empty();
+    Layouts.Empty();
+}
+
+TConstArrayView<int32> FNodeHierarchyIndex::GetChildren(int32 SlotIndex) const
+{
+    if (Entries.IsValidIndex(SlotIndex))
+    {
+        return Entries[SlotIndex].Children;
+    }
+    return TConstArrayView<int32>();
+}
+
+int32 FNodeHierarchyIndex::GetRoot(int32 SlotIndex) const
+{
+    if (!Entries.IsValidIndex(SlotIndex))
+    {
+        return SlotIndex;
+    }
+
+    while (Entries[SlotIndex].Parent != INDEX_NONE)
+    {
+        SlotIndex = Entries[SlotIndex].Parent;
+    }
+    return SlotIndex;
+}
+
+int32 FNodeHierarchyIndex::GetDepth(int32 SlotIndex) const
+{
+    int32 Depth = 0;
+    for (int32 Parent = GetParent(SlotIndex); Parent != INDEX_NONE; Parent = GetParent(Parent))
+    {
+        ++Depth;
+    }
+    return Depth;
+}
+
+bool FNodeHierarchyIndex::IsAncestorOf(int32 AncestorSlot, int32 SlotIndex) const
+{
+    for (int32 Parent = GetParent(SlotIndex); Parent != INDEX_NONE; Parent = GetParent(Parent))
+    {
+        if (Parent == AncestorSlot)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FNodeHierarchyIndex::GetAncestors(int32 SlotIndex, TArray<int32>& OutAncestors) const
+{
+    OutAncestors.Reset();
+    for (int32 Parent = GetParent(SlotIndex); Parent != INDEX_NONE; Parent = GetParent(Parent))
+    {
+        OutAncestors.Add(Parent);
+    }
+}
+
+TConstArrayView<int32> FNodeHierarchyIndex::GetSubtree(int32 SlotIndex) const
+{
+    if (!Entries.IsValidIndex(SlotIndex))
+    {
+        return TConstArrayView<int32>();
+    }
+
+    const TArray<int32>& Layout = GetLayout(GetRoot(SlotIndex));
+    const FEntry& Entry = Entries[SlotIndex];
+    return TConstArrayView<int32>(Layout.GetData() + Entry.LayoutBegin, Entry.SubtreeSize);
+}
+
+FNodeHierarchyIndex::FEntry& FNodeHierarchyIndex::GetOrAddEntry(int32 SlotIndex)
+{
+    if (Entries.Num() <= SlotIndex)
+    {
+        Entries.SetNum(SlotIndex + 1);
+    }
+    return Entries[SlotIndex];
+}
+
+void FNodeHierarchyIndex::ResolveParent(int32 SlotIndex)
+{
+    FEntry& Entry = Entries[SlotIndex];
+
+    // 最近建立的Parent连接优先，其次是场景；会成环的候选跳过
+    auto IsUsable = [this, SlotIndex](int32 Candidate)
+    {
+        return Candidate != INDEX_NONE && Candidate != SlotIndex && !IsAncestorOf(SlotIndex, Candidate);
+    };
+
+    int32 NewParent = INDEX_NONE;
+    for (int32 Index = Entry.LinkParents.Num() - 1; Index >= 0; --Index)
+    {
+        if (IsUsable(Entry.LinkParents[Index]))
+        {
+            NewParent = Entry.LinkParents[Index];
+            break;
+        }
+    }
+    if (NewParent == INDEX_NONE && IsUsable(Entry.SceneParent))
+    {
+        NewParent = Entry.SceneParent;
+    }
+
+    if (NewParent != Entry.Parent)
+    {
+        Reparent(SlotIndex, NewParent);
+    }
+}
+
+void FNodeHierarchyIndex::Reparent(int32 SlotIndex, int32 NewParent)
+{
+    // 旧树和新树的布局都失效，其他树不受影响
+    InvalidateTree(SlotIndex);
+
+    const int32 OldParent = Entries[SlotIndex].Parent;
+    if (OldParent != INDEX_NONE)
+    {
+        Entries[OldParent].Children.RemoveSingle(SlotIndex);
+    }
+
+    Entries[SlotIndex].Parent = NewParent;
+    if (NewParent != INDEX_NONE)
+    {
+        GetOrAddEntry(NewParent).Children.Add(SlotIndex);
+    }
+
+    InvalidateTree(SlotIndex);
+}
+
+void FNodeHierarchyIndex::InvalidateTree(int32 SlotIndex)
+{
+    Layouts.Remove(GetRoot(SlotIndex));
+}
+
+const TArray<int32>& FNodeHierarchyIndex::GetLayout(int32 RootSlot) const
+{
+    if (const TArray<int32>* Existing = Layouts.Find(RootSlot))
+    {
+        return *Existing;
+    }
+
+    TArray<int32>& Layout = Layouts.Add(RootSlot);
+
+    // 先序遍历，子节点逆序入栈以保持子数组顺序
+    TArray<int32, TInlineAllocator<32>> Stack;
+    Stack.Add(RootSlot);
+    while (Stack.Num() > 0)
+    {
+        const int32 Current = Stack.Pop(false);
+        const FEntry& Entry = Entries[Current];
+        Entry.LayoutBegin = Layout.Add(Current);
+        for (int32 Index = Entry.Children.Num() - 1; Index >= 0; --Index)
+        {
+            Stack.Add(Entry.Children[Index]);
+        }
+    }
+
+    // 子节点总在父节点之后，逆序累加子树大小
+    for (int32 Position = Layout.Num() - 1; Position >= 0; --Position)
+    {
+        const FEntry& Entry = Entries[Layout[Position]];
+        Entry.SubtreeSize = 1;
+        for (int32 Child : Entry.Children)
+        {
+            Entry.SubtreeSize += Entries[Child].SubtreeSize;
+        }
+    }
+
+    return Layout;
+}
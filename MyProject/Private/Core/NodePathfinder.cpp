@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodePathfinder.h"
+#include "Algo/Reverse.h"
+
+FNodePathfinder::FNodePathfinder(const FNodeAdjacencySnapshot& InGraph)
+    : Graph(InGraph)
+{
+}
+
+void FNodePathfinder::FSearchState::Init(int32 NumSlots, int32 Source)
+{
+    Cost.Init(MAX_flt, NumSlots);
+    Parent.Init(INDEX_NONE, NumSlots);
+    ParentConnection.Init(nullptr, NumSlots);
+    Closed.Init(false, NumSlots);
+    Open.Reset();
+
+    Cost[Source] = 0.0f;
+}
+
+template <typename FuncType>
+void FNodePathfinder::ForEachEdge(int32 Slot, bool bBackward, uint32 RelationMask, FuncType&& Func) const
+{
+    // 出边 Slot->Other：正向搜索顺行，反向搜索（寻找能走到Slot的前驱）则是逆行
+    Graph.ForEachNeighbor(Slot, ENodeEdgeDirection::Outgoing, RelationMask, [&](int32 Other, ANodeConnection* Connection)
+    {
+        Func(Other, Connection, bBackward);
+        return true;
+    });
+
+    // 入边 Other->Slot：与上面相反
+    Graph.ForEachNeighbor(Slot, ENodeEdgeDirection::Incoming, RelationMask, [&](int32 Other, ANodeConnection* Connection)
+    {
+        Func(Other, Connection, !bBackward);
+        return true;
+    });
+}
+
+bool FNodePathfinder::FindPath(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FHeuristicFunc Heuristic, FResult& OutResult) const
+{
+    OutResult = FResult();
+
+    if (!Graph.IsValidSlot(Start) || !Graph.IsValidSlot(Goal))
+    {
+        return false;
+    }
+
+    if (Start == Goal)
+    {
+        OutResult.bFound = true;
+        OutResult.Slots.Add(Start);
+        return true;
+    }
+
+    if (Settings.Algorithm == ENodePathAlgorithm::Bidirectional)
+    {
+        return FindPathBidirectional(Start, Goal, Settings, EdgeCost, OutResult);
+    }
+    return FindPathUnidirectional(Start, Goal, Settings, EdgeCost, Heuristic, OutResult);
+}
+
+bool FNodePathfinder::FindPathUnidirectional(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FHeuristicFunc Heuristic, FResult& OutResult) const
+{
+    const bool bUseHeuristic = Settings.Algorithm == ENodePathAlgorithm::AStar;
+    const float MaxCost = Settings.MaxCost > 0.0f ? Settings.MaxCost : MAX_flt;
+
+    FSearchState State;
+    State.Init(Graph.GetNumSlots(), Start);
+    State.Open.HeapPush(FOpenEntry{ bUseHeuristic ? Heuristic(Start) : 0.0f, 0.0f, Start });
+
+    while (State.Open.Num() > 0)
+    {
+        FOpenEntry Entry;
+        State.Open.HeapPop(Entry, false);
+
+        const int32 Current = Entry.Slot;
+        if (State.Closed[Current] || Entry.Cost > State.Cost[Current])
+        {
+            continue;
+        }
+        State.Closed[Current] = true;
+        OutResult.NodesExpanded++;
+
+        if (Current == Goal)
+        {
+            OutResult.bFound = true;
+            OutResult.TotalCost = State.Cost[Goal];
+            for (int32 Slot = Goal; Slot != Start; Slot = State.Parent[Slot])
+            {
+                OutResult.Slots.Add(Slot);
+                OutResult.Connections.Add(State.ParentConnection[Slot]);
+            }
+            OutResult.Slots.Add(Start);
+            Algo::Reverse(OutResult.Slots);
+            Algo::Reverse(OutResult.Connections);
+            return true;
+        }
+
+        ForEachEdge(Current, false, Settings.RelationMask, [&](int32 Next, ANodeConnection* Connection, bool bAgainstDirection)
+        {
+            if (State.Closed[Next])
+            {
+                return;
+            }
+
+            const float EdgeCostValue = EdgeCost(Current, Next, Connection, bAgainstDirection);
+            if (EdgeCostValue < 0.0f)
+            {
+                return;
+            }
+
+            const float NewCost = State.Cost[Current] + EdgeCostValue;
+            if (NewCost >= State.Cost[Next])
+            {
+                return;
+            }
+
+            // 启发式不高估，f值超过上限的路径不可能在上限内到达终点
+            const float Priority = bUseHeuristic ? NewCost + Heuristic(Next) : NewCost;
+            if (Priority > MaxCost)
+            {
+                return;
+            }
+
+            State.Cost[Next] = NewCost;
+            State.Parent[Next] = Current;
+            State.ParentConnection[Next] = Connection;
+            State.Open.HeapPush(FOpenEntry{ Priority, NewCost, Next });
+        });
+    }
+
+    return false;
+}
+
+bool FNodePathfinder::FindPathBidirectional(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FResult& OutResult) const
+{
+    const float MaxCost = Settings.MaxCost > 0.0f ? Settings.MaxCost : MAX_flt;
+    const int32 NumSlots = Graph.GetNumSlots();
+
+    // 0为从起点出发的正向搜索，1为从终点出发的反向搜索
+    FSearchState States[2];
+    States[0].Init(NumSlots, Start);
+    States[1].Init(NumSlots, Goal);
+    States[0].Open.HeapPush(FOpenEntry{ 0.0f, 0.0f, Start });
+    States[1].Open.HeapPush(FOpenEntry{ 0.0f, 0.0f, Goal });
+
+    float BestCost = MAX_flt;
+    int32 MeetSlot = INDEX_NONE;
+
+    while (States[0].Open.Num() > 0 && States[1].Open.Num() > 0)
+    {
+        // 两侧最小值之和不小于当前最优时，不可能再找到更短的路径
+        if (States[0].TopPriority() + States[1].TopPriority() >= FMath::Min(BestCost, MaxCost))
+        {
+            break;
+        }
+
+        // 扩展开放表较小的一侧
+        const int32 Side = States[0].Open.Num() <= States[1].Open.Num() ? 0 : 1;
+        const bool bBackward = Side == 1;
+        FSearchState& State = States[Side];
+        const FSearchState& Other = States[1 - Side];
+
+        FOpenEntry Entry;
+        State.Open.HeapPop(Entry, false);
+
+        const int32 Current = Entry.Slot;
+        if (State.Closed[Current] || Entry.Cost > State.Cost[Current])
+        {
+            continue;
+        }
+        State.Closed[Current] = true;
+        OutResult.NodesExpanded++;
+
+        ForEachEdge(Current, bBackward, Settings.RelationMask, [&](int32 Next, ANodeConnection* Connection, bool bAgainstDirection)
+        {
+            if (State.Closed[Next])
+            {
+                return;
+            }
+
+            // 代价始终按正向行走方向计算
+            const float EdgeCostValue = bBackward
+                ? EdgeCost(Next, Current, Connection, bAgainstDirection)
+                : EdgeCost(Current, Next, Connection, bAgainstDirection);
+            if (EdgeCostValue < 0.0f)
+            {
+                return;
+            }
+
+            const float NewCost = State.Cost[Current] + EdgeCostValue;
+            if (NewCost > MaxCost || NewCost >= State.Cost[Next])
+            {
+                return;
+            }
+
+            State.Cost[Next] = NewCost;
+            State.Parent[Next] = Current;
+            State.ParentConnection[Next] = Connection;
+            State.Open.HeapPush(FOpenEntry{ NewCost, NewCost, Next });
+
+            // 两侧搜索在Next相遇
+            if (Other.Cost[Next] < MAX_flt)
+            {
+                const float PathCost = NewCost + Other.Cost[Next];
+                if (PathCost < BestCost && PathCost <= MaxCost)
+                {
+                    BestCost = PathCost;
+                    MeetSlot = Next;
+                }
+            }
+        });
+    }
+
+    if (MeetSlot == INDEX_NONE)
+    {
+        return false;
+    }
+
+    // 正向半段：相遇点回溯到起点后反转
+    for (int32 Slot = MeetSlot; Slot != Start; Slot = States[0].Parent[Slot])
+    {
+        OutResult.Slots.Add(Slot);
+        OutResult.Connections.Add(States[0].ParentConnection[Slot]);
+    }
+    OutResult.Slots.Add(Start);
+    Algo::Reverse(OutResult.Slots);
+    Algo::Reverse(OutResult.Connections);
+
+    // 反向半段：反向搜索的前驱即正向路径上的后继
+    for (int32 Slot = MeetSlot; Slot != Goal; Slot = States[1].Parent[Slot])
+    {
+        OutResult.Connections.Add(States[1].ParentConnection[Slot]);
+        OutResult.Slots.Add(States[1].Parent[Slot]);
+    }
+
+    OutResult.bFound = true;
+    OutResult.TotalCost = BestCost;
+    return true;
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeSignificance.h"
+
+ENodeSignificanceTier FNodeSignificanceTracker::EvaluateTier(const FNodeSignificanceInput& Input, ENodeSignificanceTier CurrentTier, const FNodeSignificanceSettings& Settings)
+{
+    if (!Input.bInActiveScene)
+    {
+        return ENodeSignificanceTier::Dormant;
+    }
+
+    const float Thresholds[] = { Settings.FullDistance, Settings.ReducedDistance, Settings.MinimalDistance };
+
+    // 阈值按当前层级偏移：更高层级的阈值放宽（保持），更低层级的阈值收紧（需明显靠近才升级）
+    int32 TierIndex = UE_ARRAY_COUNT(Thresholds);
+    for (int32 Index = 0; Index < UE_ARRAY_COUNT(Thresholds); ++Index)
+    {
+        const bool bHoldingTier = Index >= static_cast<int32>(CurrentTier);
+        const float Threshold = Thresholds[Index] * (bHoldingTier ? 1.0f + Settings.Hysteresis : 1.0f - Settings.Hysteresis);
+        if (Input.DistanceSquared <= FMath::Square(Threshold))
+        {
+            TierIndex = Index;
+            break;
+        }
+    }
+
+    // 视锥外不需要UI、Tick和动画，但保留碰撞供射线和物理使用
+    if (!Input.bInFrustum)
+    {
+        TierIndex = FMath::Max(TierIndex, static_cast<int32>(ENodeSignificanceTier::Reduced));
+    }
+
+    return static_cast<ENodeSignificanceTier>(TierIndex);
+}
+
+bool FNodeSignificanceTracker::SetTier(int32 SlotIndex, ENodeSignificanceTier Tier)
+{
+    if (SlotIndex < 0)
+    {
+        return false;
+    }
+
+    if (Tiers.Num() <= SlotIndex)
+    {
+        Tiers.SetNum(SlotIndex + 1);
+    }
+
+    if (Tiers[SlotIndex] == Tier)
+    {
+        return false;
+    }
+
+    Tiers[SlotIndex] = Tier;
+    return true;
+}
+
+void FNodeSignificanceTracker::RemoveSlot(int32 SlotIndex)
+{
+    if (Tiers.IsValidIndex(SlotIndex))
+    {
+        Tiers[SlotIndex] = ENodeSignificanceTier::Full;
+    }
+}
+
+void FNodeSignificanceTracker::Reset()
+{
+    Tiers.Empty();
+    Cursor = 0;
+}
+
+int32 FNodeSignificanceTracker::AdvanceCursor(int32 SlotCount)
+{
+    if (SlotCount <= 0)
+    {
+        return INDEX_NONE;
+    }
+
+    if (Cursor >= SlotCount)
+    {
+        Cursor = 0;
+    }
+    return Cursor++;
+}
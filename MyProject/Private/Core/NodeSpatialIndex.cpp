@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeSpatialIndex.h"
+
+FNodeSpatialIndex::FNodeSpatialIndex()
+{
+    NumEntries = 0;
+    CellSize = 500.0f;
+    InvCellSize = 1.0f / CellSize;
+}
+
+template <typename FuncType>
+void FNodeSpatialIndex::ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, FuncType&& Func) const
+{
+    const int64 RangeCells =
+        static_cast<int64>(MaxCell.X - MinCell.X + 1) *
+        static_cast<int64>(MaxCell.Y - MinCell.Y + 1) *
+        static_cast<int64>(MaxCell.Z - MinCell.Z + 1);
+
+    if (RangeCells > Cells.Num())
+    {
+        for (const auto& Pair : Cells)
+        {
+            const FIntVector& Cell = Pair.Key;
+            if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X &&
+                Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y &&
+                Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z)
+            {
+                Func(Pair.Value);
+            }
+        }
+        return;
+    }
+
+    for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+    {
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+        {
+            for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+            {
+                if (const TArray<int32>* CellSlots = Cells.Find(FIntVector(X, Y, Z)))
+                {
+                    Func(*CellSlots);
+                }
+            }
+        }
+    }
+}
+
+void FNodeSpatialIndex::SetCellSize(float InCellSize)
+{
+    InCellSize = FMath::Max(InCellSize, 1.0f);
+    if (FMath::IsNearlyEqual(InCellSize, CellSize))
+    {
+        return;
+    }
+
+    CellSize = InCellSize;
+    InvCellSize = 1.0f / CellSize;
+
+    // 按新尺寸重新分配格子
+    Cells.Empty();
+    for (int32 SlotIndex = 0; SlotIndex < Entries.Num(); ++SlotIndex)
+    {
+        if (Entries[SlotIndex].CellIndex != INDEX_NONE)
+        {
+            AddToCell(SlotIndex, ToCell(Entries[SlotIndex].Location));
+        }
+    }
+}
+
+void FNodeSpatialIndex::Insert(int32 SlotIndex, const FVector& Location)
+{
+    if (SlotIndex < 0)
+    {
+        return;
+    }
+
+    if (Contains(SlotIndex))
+    {
+        Update(SlotIndex, Location);
+        return;
+    }
+
+    if (Entries.Num() <= SlotIndex)
+    {
+        Entries.SetNum(SlotIndex + 1);
+    }
+
+    Entries[SlotIndex].Location = Location;
+    AddToCell(SlotIndex, ToCell(Location));
+    NumEntries++;
+}
+
+void FNodeSpatialIndex::Update(int32 SlotIndex, const FVector& Location)
+{
+    if (!Contains(SlotIndex))
+    {
+        Insert(SlotIndex, Location);
+        return;
+    }
+
+    FEntry& Entry = Entries[SlotIndex];
+    Entry.Location = Location;
+
+    // 仍在同一格子内时只更新位置
+    const FIntVector NewCell = ToCell(Location);
+    if (NewCell != Entry.Cell)
+    {
+        RemoveFromCell(SlotIndex);
+        AddToCell(SlotIndex, NewCell);
+    }
+}
+
+void FNodeSpatialIndex::Remove(int32 SlotIndex)
+{
+    if (!Contains(SlotIndex))
+    {
+        return;
+    }
+
+    RemoveFromCell(SlotIndex);
+    NumEntries--;
+}
+
+void FNodeSpatialIndex::Reset()
+{
+    Entries.Empty();
+    Cells.Empty();
+    NumEntries = 0;
+}
+
+void FNodeSpatialIndex::QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutSlots) const
+{
+    OutSlots.Reset();
+    if (Radius < 0.0f || NumEntries == 0)
+    {
+        return;
+    }
+
+    const float RadiusSq = Radius * Radius;
+    const FVector Extent(Radius);
+
+    ForEachCellInRange(ToCell(Center - Extent), ToCell(Center + Extent), [&](const TArray<int32>& CellSlots)
+    {
+        for (int32 SlotIndex : CellSlots)
+        {
+            if (FVector::DistSquared(Entries[SlotIndex].Location, Center) <= RadiusSq)
+            {
+                OutSlots.Add(SlotIndex);
+            }
+        }
+    });
+}
+
+int32 FNodeSpatialIndex::EstimateRadiusCount(const FVector& Center, float Radius) const
+{
+    if (Radius < 0.0f || NumEntries == 0)
+    {
+        return 0;
+    }
+
+    int32 Count = 0;
+    const FVector Extent(Radius);
+    ForEachCellInRange(ToCell(Center - Extent), ToCell(Center + Extent), [&Count](const TArray<int32>& CellSlots)
+    {
+        Count += CellSlots.Num();
+    });
+    return Count;
+}
+
+void FNodeSpatialIndex::QueryBox(const FBox& Box, TArray<int32>& OutSlots) const
+{
+    OutSlots.Reset();
+    if (!Box.IsValid || NumEntries == 0)
+    {
+        return;
+    }
+
+    ForEachCellInRange(ToCell(Box.Min), ToCell(Box.Max), [&](const TArray<int32>& CellSlots)
+    {
+        for (int32 SlotIndex : CellSlots)
+        {
+            if (Box.IsInsideOrOn(Entries[SlotIndex].Location))
+            {
+                OutSlots.Add(SlotIndex);
+            }
+        }
+    });
+}
+
+void FNodeSpatialIndex::QueryNearest(const FVector& Center, int32 Count, float MaxRadius, TArray<int32>& OutSlots) const
+{
+    OutSlots.Reset();
+    if (Count <= 0 || NumEntries == 0)
+    {
+        return;
+    }
+
+    const float MaxRadiusSq = MaxRadius > 0.0f ? MaxRadius * MaxRadius : MAX_flt;
+    const FIntVector CenterCell = ToCell(Center);
+
+    // (距离平方, 槽位索引)
+    TArray<TPair<float, int32>> Candidates;
+    auto SortCandidates = [&Candidates, Count]()
+    {
+        Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+        {
+            return A.Key < B.Key;
+        });
+        if (Candidates.Num() > Count)
+        {
+            Candidates.SetNum(Count, false);
+        }
+    };
+
+    auto GatherCell = [&](const TArray<int32>& CellSlots)
+    {
+        for (int32 SlotIndex : CellSlots)
+        {
+            const float DistSq = FVector::DistSquared(Entries[SlotIndex].Location, Center);
+            if (DistSq <= MaxRadiusSq)
+            {
+                Candidates.Emplace(DistSq, SlotIndex);
+            }
+        }
+    };
+
+    // 由内向外逐圈扩展，直到第Count近的节点不可能被更外圈的节点超过
+    int32 Visited = 0;
+    for (int32 Ring = 0; ; ++Ring)
+    {
+        const int64 Side = 2 * Ring + 1;
+        const int64 InnerSide = FMath::Max<int64>(Side - 2, 0);
+        const int64 ShellCells = Side * Side * Side - InnerSide * InnerSide * InnerSide;
+
+        if (ShellCells > Cells.Num())
+        {
+            // 外圈已经比整个网格稀疏，直接扫描剩余格子
+            for (const auto& Pair : Cells)
+            {
+                const FIntVector Offset = Pair.Key - CenterCell;
+                const int32 Chebyshev = FMath::Max3(FMath::Abs(Offset.X), FMath::Abs(Offset.Y), FMath::Abs(Offset.Z));
+                if (Chebyshev >= Ring)
+                {
+                    GatherCell(Pair.Value);
+                }
+            }
+            break;
+        }
+
+        for (int32 DX = -Ring; DX <= Ring; ++DX)
+        {
+            for (int32 DY = -Ring; DY <= Ring; ++DY)
+            {
+                // 只访问本圈外壳上的格子
+                const bool bOnShellXY = FMath::Abs(DX) == Ring || FMath::Abs(DY) == Ring;
+                const int32 DZStep = (bOnShellXY || Ring == 0) ? 1 : 2 * Ring;
+                for (int32 DZ = -Ring; DZ <= Ring; DZ += DZStep)
+                {
+                    if (const TArray<int32>* CellSlots = Cells.Find(CenterCell + FIntVector(DX, DY, DZ)))
+                    {
+                        GatherCell(*CellSlots);
+                        Visited += CellSlots->Num();
+                    }
+                }
+            }
+        }
+
+        if (Visited >= NumEntries)
+        {
+            break;
+        }
+
+        // 未访问格子中的点距中心至少为 Ring * CellSize
+        const float Reach = Ring * CellSize;
+        if (Reach * Reach > MaxRadiusSq)
+        {
+            break;
+        }
+
+        if (Candidates.Num() >= Count)
+        {
+            SortCandidates();
+            if (Candidates.Last().Key <= Reach * Reach)
+            {
+                break;
+            }
+        }
+    }
+
+    SortCandidates();
+    OutSlots.Reserve(Candidates.Num());
+    for (const TPair<float, int32>& Candidate : Candidates)
+    {
+        OutSlots.Add(Candidate.Value);
+    }
+}
+
+FIntVector FNodeSpatialIndex::ToCell(const FVector& Location) const
+{
+    return FIntVector(
+        FMath::FloorToInt(Location.X * InvCellSize),
+        FMath::FloorToInt(Location.Y * InvCellSize),
+        FMath::FloorToInt(Location.Z * InvCellSize)
+    );
+}
+
+void FNodeSpatialIndex::AddToCell(int32 SlotIndex, const FIntVector& Cell)
+{
+    FEntry& Entry = Entries[SlotIndex];
+    Entry.Cell = Cell;
+    Entry.CellIndex = Cells.FindOrAdd(Cell).Add(SlotIndex);
+}
+
+void FNodeSpatialIndex::RemoveFromCell(int32 SlotIndex)
+{
+    FEntry& Entry = Entries[SlotIndex];
+    TArray<int32>* CellSlots = Cells.Find(Entry.Cell);
+    if (CellSlots && CellSlots->IsValidIndex(Entry.CellIndex))
+    {
+        // 用格子尾元素填补空位，并修正它记录的下标
+        CellSlots->RemoveAtSwap(Entry.CellIndex, 1, false);
+        if (CellSlots->IsValidIndex(Entry.CellIndex))
+        {
+            Entries[(*CellSlots)[Entry.CellIndex]].CellIndex = Entry.CellIndex;
+        }
+        if (CellSlots->Num() == 0)
+        {
+            Cells.Remove(Entry.Cell);
+        }
+    }
+
+    Entry.CellIndex = INDEX_NONE;
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeStatePropagator.h"
+
+bool FNodeStatePropagator::Enqueue(const FNodeStateChangeRecord& Record, int32 Priority)
+{
+    if (Record.Slot < 0)
+    {
+        return false;
+    }
+
+    EnsureSlot(Record.Slot);
+
+    const uint32 StateBit = 1u << static_cast<uint32>(Record.NewState);
+    const FAppliedStamp& Stamp = Applied[Record.Slot];
+    if (Stamp.Epoch == Epoch && (Stamp.StateMask & StateBit))
+    {
+        return false;
+    }
+
+    // 已有待处理记录时只覆盖内容，保留原来的队列位置
+    FNodeStateChangeRecord& Existing = Pending[Record.Slot];
+    if (Existing.Slot == INDEX_NONE)
+    {
+        PendingSequences[Record.Slot] = NextSequence;
+        Heap.HeapPush(FQueueEntry{ Priority, NextSequence++, Record.Slot });
+        ++NumPending;
+    }
+    Existing = Record;
+    return true;
+}
+
+bool FNodeStatePropagator::Dequeue(FNodeStateChangeRecord& OutRecord)
+{
+    while (Heap.Num() > 0)
+    {
+        FQueueEntry Entry;
+        Heap.HeapPop(Entry, false);
+
+        // 被RemoveSlot丢弃的记录，以及槽位复用后留下的旧堆项在这里跳过
+        if (!IsLiveEntry(Entry))
+        {
+            continue;
+        }
+
+        FNodeStateChangeRecord& Record = Pending[Entry.Slot];
+        OutRecord = Record;
+        Record = FNodeStateChangeRecord();
+        --NumPending;
+
+        FAppliedStamp& Stamp = Applied[Entry.Slot];
+        if (Stamp.Epoch != Epoch)
+        {
+            Stamp.Epoch = Epoch;
+            Stamp.StateMask = 0;
+        }
+        Stamp.StateMask |= 1u << static_cast<uint32>(OutRecord.NewState);
+        return true;
+    }
+
+    return false;
+}
+
+void FNodeStatePropagator::RemoveSlot(int32 SlotIndex)
+{
+    if (!Pending.IsValidIndex(SlotIndex))
+    {
+        return;
+    }
+
+    if (Pending[SlotIndex].Slot != INDEX_NONE)
+    {
+        Pending[SlotIndex] = FNodeStateChangeRecord();
+        --NumPending;
+    }
+    Applied[SlotIndex] = FAppliedStamp();
+
+    // 失效堆项过多时整体压缩，避免大量注销后堆一直膨胀到下一次排空
+    if (Heap.Num() > 2 * NumPending + 64)
+    {
+        Heap.RemoveAllSwap([this](const FQueueEntry& Entry) { return !IsLiveEntry(Entry); });
+        Heap.Heapify();
+    }
+}
+
+void FNodeStatePropagator::Reset()
+{
+    Heap.Empty();
+    Pending.Empty();
+    PendingSequences.Empty();
+    Applied.Empty();
+    NumPending = 0;
+    NextSequence = 0;
+    ++Epoch;
+}
+
+void FNodeStatePropagator::EnsureSlot(int32 SlotIndex)
+{
+    if (Pending.Num() <= SlotIndex)
+    {
+        Pending.SetNum(SlotIndex + 1);
+        PendingSequences.SetNumZeroed(SlotIndex + 1);
+        Applied.SetNum(SlotIndex + 1);
+    }
+}
@@ -0,0 +1,423 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core/NodeTagIndex.h"
+
+namespace
+{
+    // 表达式树是否只包含位集可求值的类型
+    bool IsIndexableExpr(const FGameplayTagQueryExpression& Expr)
+    {
+        switch (Expr.ExprType)
+        {
+            case EGameplayTagQueryExprType::AnyTagsMatch:
+            case EGameplayTagQueryExprType::AllTagsMatch:
+            case EGameplayTagQueryExprType::NoTagsMatch:
+                return true;
+            case EGameplayTagQueryExprType::AnyExprMatch:
+            case EGameplayTagQueryExprType::AllExprMatch:
+            case EGameplayTagQueryExprType::NoExprMatch:
+                for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+                {
+                    if (!IsIndexableExpr(SubExpr))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+FCompiledNodeTagQuery::FCompiledNodeTagQuery(const FGameplayTagQuery& Query)
+{
+    bMatchAll = Query.IsEmpty();
+    if (!bMatchAll)
+    {
+        Query.GetQueryExpr(Root);
+        SourceQuery = Query;
+        bRequiresFallback = !IsIndexableExpr(Root);
+    }
+}
+
+void FNodeTagIndex::AddNode(int32 SlotIndex, const FGameplayTagContainer& Tags)
+{
+    if (SlotIndex < 0)
+    {
+        return;
+    }
+
+    RemoveNode(SlotIndex);
+    EnsureSlotCapacity(SlotIndex);
+
+    // 展开父标签，使层级匹配退化为单列查找
+    const FGameplayTagContainer ExpandedTags = Tags.GetGameplayTagParents();
+
+    TBitArray<>& NodeBits = NodeTagBits[SlotIndex];
+    for (const FGameplayTag& Tag : ExpandedTags)
+    {
+        const int32 Column = FindOrAddColumn(Tag);
+        TagColumns[Column][SlotIndex] = true;
+        TagColumnCounts[Column]++;
+
+        if (NodeBits.Num() <= Column)
+        {
+            NodeBits.Add(false, Column + 1 - NodeBits.Num());
+        }
+        NodeBits[Column] = true;
+    }
+
+    NodeTagContainers[SlotIndex] = Tags;
+    LiveSlots[SlotIndex] = true;
+    NumLiveNodes++;
+}
+
+void FNodeTagIndex::RemoveNode(int32 SlotIndex)
+{
+    if (!ContainsNode(SlotIndex))
+    {
+        return;
+    }
+
+    TBitArray<>& NodeBits = NodeTagBits[SlotIndex];
+    for (TConstSetBitIterator<> It(NodeBits); It; ++It)
+    {
+        const int32 Column = It.GetIndex();
+        TagColumns[Column][SlotIndex] = false;
+        TagColumnCounts[Column]--;
+    }
+    NodeBits.Empty();
+    NodeTagContainers[SlotIndex].Reset();
+
+    LiveSlots[SlotIndex] = false;
+    NumLiveNodes--;
+}
+
+void FNodeTagIndex::Reset()
+{
+    TagDictionary.Empty();
+    TagColumns.Empty();
+    TagColumnCounts.Empty();
+    NodeTagBits.Empty();
+    NodeTagContainers.Empty();
+    LiveSlots.Empty();
+    NumLiveNodes = 0;
+    SlotCapacity = 0;
+}
+
+void FNodeTagIndex::ReserveSlots(int32 NumSlots)
+{
+    if (NumSlots > 0)
+    {
+        EnsureSlotCapacity(NumSlots - 1);
+    }
+}
+
+bool FNodeTagIndex::NodeHasTag(int32 SlotIndex, const FGameplayTag& Tag) const
+{
+    const int32* Column = TagDictionary.Find(Tag);
+    if (!Column || !ContainsNode(SlotIndex))
+    {
+        return false;
+    }
+
+    const TBitArray<>& NodeBits = NodeTagBits[SlotIndex];
+    return NodeBits.IsValidIndex(*Column) && NodeBits[*Column];
+}
+
+TBitArray<> FNodeTagIndex::Evaluate(const FCompiledNodeTagQuery& Query) const
+{
+    if (Query.bMatchAll)
+    {
+        return LiveSlots;
+    }
+    return Query.bRequiresFallback ? EvaluateFallback(Query.SourceQuery) : EvaluateExpr(Query.Root);
+}
+
+bool FNodeTagIndex::MatchesNode(const FCompiledNodeTagQuery& Query, int32 SlotIndex) const
+{
+    if (!ContainsNode(SlotIndex))
+    {
+        return false;
+    }
+    if (Query.bMatchAll)
+    {
+        return true;
+    }
+    return Query.bRequiresFallback ? Query.SourceQuery.Matches(NodeTagContainers[SlotIndex]) : MatchesExpr(Query.Root, SlotIndex);
+}
+
+int32 FNodeTagIndex::GetTagCount(const FGameplayTag& Tag) const
+{
+    const int32* Column = TagDictionary.Find(Tag);
+    return Column ? TagColumnCounts[*Column] : 0;
+}
+
+int32 FNodeTagIndex::EstimateMatchCount(const FCompiledNodeTagQuery& Query) const
+{
+    // 回退查询需要逐个检查所有存活节点，按全量计费
+    if (Query.bMatchAll || Query.bRequiresFallback)
+    {
+        return NumLiveNodes;
+    }
+    return EstimateExpr(Query.Root);
+}
+
+int32 FNodeTagIndex::FindOrAddColumn(const FGameplayTag& Tag)
+{
+    if (const int32* Existing = TagDictionary.Find(Tag))
+    {
+        return *Existing;
+    }
+
+    const int32 Column = TagColumns.Emplace(false, SlotCapacity);
+    TagColumnCounts.Add(0);
+    TagDictionary.Add(Tag, Column);
+    return Column;
+}
+
+const TBitArray<>* FNodeTagIndex::FindColumn(const FGameplayTag& Tag) const
+{
+    const int32* Column = TagDictionary.Find(Tag);
+    return Column ? &TagColumns[*Column] : nullptr;
+}
+
+void FNodeTagIndex::EnsureSlotCapacity(int32 SlotIndex)
+{
+    if (SlotIndex < SlotCapacity)
+    {
+        return;
+    }
+
+    // 按倍数扩容，避免每注册一个节点就把所有列都增长一次
+    const int32 NewCapacity = FMath::Max(SlotIndex + 1, FMath::Max(64, SlotCapacity * 2));
+    const int32 Growth = NewCapacity - SlotCapacity;
+
+    for (TBitArray<>& Column : TagColumns)
+    {
+        Column.Add(false, Growth);
+    }
+    LiveSlots.Add(false, Growth);
+    NodeTagBits.SetNum(NewCapacity);
+    NodeTagContainers.SetNum(NewCapacity);
+
+    SlotCapacity = NewCapacity;
+}
+
+TBitArray<> FNodeTagIndex::EvaluateFallback(const FGameplayTagQuery& Query) const
+{
+    TBitArray<> Result(false, SlotCapacity);
+    for (TConstSetBitIterator<> It(LiveSlots); It; ++It)
+    {
+        const int32 SlotIndex = It.GetIndex();
+        if (Query.Matches(NodeTagContainers[SlotIndex]))
+        {
+            Result[SlotIndex] = true;
+        }
+    }
+    return Result;
+}
+
+TBitArray<> FNodeTagIndex::EvaluateExpr(const FGameplayTagQueryExpression& Expr) const
+{
+    switch (Expr.ExprType)
+    {
+        case EGameplayTagQueryExprType::AnyTagsMatch:
+        {
+            TBitArray<> Result(false, SlotCapacity);
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (const TBitArray<>* Column = FindColumn(Tag))
+                {
+                    Result.CombineWithBitwiseOR(*Column, EBitwiseOperatorFlags::MaintainSize);
+                }
+            }
+            return Result;
+        }
+        case EGameplayTagQueryExprType::AllTagsMatch:
+        {
+            TBitArray<> Result = LiveSlots;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                const TBitArray<>* Column = FindColumn(Tag);
+                if (!Column)
+                {
+                    // 没有任何节点拥有该标签
+                    return TBitArray<>(false, SlotCapacity);
+                }
+                Result.CombineWithBitwiseAND(*Column, EBitwiseOperatorFlags::MaintainSize);
+            }
+            return Result;
+        }
+        case EGameplayTagQueryExprType::NoTagsMatch:
+        {
+            TBitArray<> Result = LiveSlots;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (const TBitArray<>* Column = FindColumn(Tag))
+                {
+                    TBitArray<> Inverted = *Column;
+                    Inverted.BitwiseNOT();
+                    Result.CombineWithBitwiseAND(Inverted, EBitwiseOperatorFlags::MaintainSize);
+                }
+            }
+            return Result;
+        }
+        case EGameplayTagQueryExprType::AnyExprMatch:
+        {
+            TBitArray<> Result(false, SlotCapacity);
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                Result.CombineWithBitwiseOR(EvaluateExpr(SubExpr), EBitwiseOperatorFlags::MaintainSize);
+            }
+            return Result;
+        }
+        case EGameplayTagQueryExprType::AllExprMatch:
+        {
+            TBitArray<> Result = LiveSlots;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                Result.CombineWithBitwiseAND(EvaluateExpr(SubExpr), EBitwiseOperatorFlags::MaintainSize);
+            }
+            return Result;
+        }
+        case EGameplayTagQueryExprType::NoExprMatch:
+        {
+            TBitArray<> Result = LiveSlots;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                TBitArray<> Inverted = EvaluateExpr(SubExpr);
+                Inverted.BitwiseNOT();
+                Result.CombineWithBitwiseAND(Inverted, EBitwiseOperatorFlags::MaintainSize);
+            }
+            return Result;
+        }
+        default:
+            // 不可索引的表达式在编译时已转为回退路径，这里不会匹配任何节点
+            return TBitArray<>(false, SlotCapacity);
+    }
+}
+
+int32 FNodeTagIndex::EstimateExpr(const FGameplayTagQueryExpression& Expr) const
+{
+    switch (Expr.ExprType)
+    {
+        case EGameplayTagQueryExprType::AnyTagsMatch:
+        {
+            int32 Sum = 0;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                Sum += GetTagCount(Tag);
+            }
+            return FMath::Min(Sum, NumLiveNodes);
+        }
+        case EGameplayTagQueryExprType::AllTagsMatch:
+        {
+            int32 Min = NumLiveNodes;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                Min = FMath::Min(Min, GetTagCount(Tag));
+            }
+            return Min;
+        }
+        case EGameplayTagQueryExprType::NoTagsMatch:
+        {
+            // 至少要排除拥有其中最常见标签的节点
+            int32 Max = 0;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                Max = FMath::Max(Max, GetTagCount(Tag));
+            }
+            return NumLiveNodes - Max;
+        }
+        case EGameplayTagQueryExprType::AnyExprMatch:
+        {
+            int32 Sum = 0;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                Sum += EstimateExpr(SubExpr);
+            }
+            return FMath::Min(Sum, NumLiveNodes);
+        }
+        case EGameplayTagQueryExprType::AllExprMatch:
+        {
+            int32 Min = NumLiveNodes;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                Min = FMath::Min(Min, EstimateExpr(SubExpr));
+            }
+            return Min;
+        }
+        case EGameplayTagQueryExprType::NoExprMatch:
+            // 子表达式只有上限估算，无法据此收紧否定的上限
+            return NumLiveNodes;
+        default:
+            // 不可索引的表达式在编译时已转为回退路径
+            return 0;
+    }
+}
+
+bool FNodeTagIndex::MatchesExpr(const FGameplayTagQueryExpression& Expr, int32 SlotIndex) const
+{
+    switch (Expr.ExprType)
+    {
+        case EGameplayTagQueryExprType::AnyTagsMatch:
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (NodeHasTag(SlotIndex, Tag))
+                {
+                    return true;
+                }
+            }
+            return false;
+        case EGameplayTagQueryExprType::AllTagsMatch:
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (!NodeHasTag(SlotIndex, Tag))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case EGameplayTagQueryExprType::NoTagsMatch:
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (NodeHasTag(SlotIndex, Tag))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case EGameplayTagQueryExprType::AnyExprMatch:
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                if (MatchesExpr(SubExpr, SlotIndex))
+                {
+                    return true;
+                }
+            }
+            return false;
+        case EGameplayTagQueryExprType::AllExprMatch:
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                if (!MatchesExpr(SubExpr, SlotIndex))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case EGameplayTagQueryExprType::NoExprMatch:
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                if (MatchesExpr(SubExpr, SlotIndex))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            // 不可索引的表达式在编译时已转为回退路径
+            return false;
+    }
+}
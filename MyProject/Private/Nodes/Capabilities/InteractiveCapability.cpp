@@ -592,12 +592,14 @@ bool UInteractiveCapability::CompareNodeProperties(AInteractiveNode* NodeA, AInt
     }
     
     // 比较节点数据中的自定义属性
-    FNodeData DataA = NodeA->GetNodeData();
-    FNodeData DataB = NodeB->GetNodeData();
+    const FNodeData& DataA = NodeA->GetNodeDataRef();
+    const FNodeData& DataB = NodeB->GetNodeDataRef();
     
-    if (DataA.CustomProperties.Contains(PropertyKey) && DataB.CustomProperties.Contains(PropertyKey))
+    const FString* ValueA = DataA.CustomProperties.Find(PropertyKey);
+    const FString* ValueB = DataB.CustomProperties.Find(PropertyKey);
+    if (ValueA && ValueB)
     {
-        return DataA.CustomProperties[PropertyKey].Equals(DataB.CustomProperties[PropertyKey]);
+        return ValueA->Equals(*ValueB);
     }
     
     // 比较基本属性
@@ -161,8 +161,7 @@ void UNarrativeCapability::AdvanceStory(const FString& NextBeat)
     if (SystemManager)
     {
         // 查找具有对应故事片段的节点
-        TArray<AInteractiveNode*> AllNodes = SystemManager->GetNodesByType(ENodeType::Story);
-        for (AInteractiveNode* Node : AllNodes)
+        for (AInteractiveNode* Node : SystemManager->GetNodesByTypeView(ENodeType::Story))
         {
             if (Node && Node->StoryFragmentID == NextBeat)
             {
@@ -649,8 +648,7 @@ ANodeConnection* UNarrativeCapability::CreateEventTriggerConnection(const FStrin
     }
     
     // 查找具有对应事件ID的节点
-    TArray<AInteractiveNode*> AllNodes = SystemManager->GetNodesByType(ENodeType::Trigger);
-    for (AInteractiveNode* Node : AllNodes)
+    for (AInteractiveNode* Node : SystemManager->GetNodesByTypeView(ENodeType::Trigger))
     {
         if (Node && Node->TriggerEventIDs.Contains(EventNodeID))
         {
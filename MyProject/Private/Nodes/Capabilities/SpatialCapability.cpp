@@ -263,7 +263,7 @@ bool USpatialCapability::TeleportPlayer(APlayerController* Player)
         ANodeSystemManager* SystemManager = GetNodeSystemManager();
         if (SystemManager)
         {
-            AInteractiveNode* TargetNode = SystemManager->GetNode(TeleportTargetNodeID);
+            AInteractiveNode* TargetNode = SystemManager->ResolveNode(TeleportTargetNodeID, TeleportTargetHandle);
             if (TargetNode)
             {
                 TargetLocation = TargetNode->GetActorLocation();
@@ -292,6 +292,7 @@ void USpatialCapability::SetTeleportTarget(const FVector& Location)
 void USpatialCapability::SetTeleportTargetNode(const FString& NodeID)
 {
     TeleportTargetNodeID = NodeID;
+    TeleportTargetHandle.Invalidate();
     bTeleportToNode = true;
 }
 
@@ -81,21 +81,35 @@ void UStateCapability::BeginPlay()
 {
     Super::BeginPlay();
     
-    // 启动自动状态检查
+    // 启动自动状态检查；有管理器时登记给管理器统一检查，首次检查同样在一个间隔之后
     if (bAutoCheckState && StateCheckInterval > 0.0f)
     {
-        GetWorld()->GetTimerManager().SetTimer(
-            StateCheckTimerHandle,
-            this,
-            &UStateCapability::OnStateCheckTimer,
-            StateCheckInterval,
-            true
-        );
+        NextStateCheckTime = GetWorld()->GetTimeSeconds() + StateCheckInterval;
+        if (ANodeSystemManager* SystemManager = GetNodeSystemManager())
+        {
+            CachedSystemManager = SystemManager;
+            SystemManager->RegisterStateCheck(this);
+        }
+        else
+        {
+            GetWorld()->GetTimerManager().SetTimer(
+                StateCheckTimerHandle,
+                this,
+                &UStateCapability::OnStateCheckTimer,
+                StateCheckInterval,
+                true
+            );
+        }
     }
 }
 
 void UStateCapability::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    if (StateCheckIndex != INDEX_NONE && IsValid(CachedSystemManager))
+    {
+        CachedSystemManager->UnregisterStateCheck(this);
+    }
+
     // 清理定时器
     if (StateCheckTimerHandle.IsValid())
     {
@@ -255,8 +269,8 @@ void UStateCapability::ApplyStateToConnectedNodes(ENodeState NewState)
         return;
     }
     
-    // 获取所有连接的节点
-    TArray<ANodeConnection*> Connections = SystemManager->GetConnectionsForNode(OwnerItem->GetNodeID());
+    // 获取所有连接的节点（改变状态会触发事件，可能改动连接表，先拷贝到栈上）
+    TArray<ANodeConnection*, TInlineAllocator<16>> Connections(SystemManager->GetConnectionsView(OwnerItem->GetNodeHandle()));
     
     for (ANodeConnection* Connection : Connections)
     {
@@ -572,11 +586,8 @@ TArray<ANodeConnection*> UStateCapability::GetDependencyConnections() const
         return Result;
     }
     
-    // 获取所有连接
-    TArray<ANodeConnection*> AllConnections = SystemManager->GetConnectionsForNode(OwnerItem->GetNodeID());
-    
     // 过滤Dependency类型的连接
-    for (ANodeConnection* Connection : AllConnections)
+    for (ANodeConnection* Connection : SystemManager->GetConnectionsView(OwnerItem->GetNodeHandle()))
     {
         if (Connection && Connection->RelationType == ENodeRelationType::Dependency)
         {
@@ -597,11 +608,30 @@ void UStateCapability::OnStateCheckTimer()
     // 检查状态条件
     if (CheckStateConditions())
     {
-        // 如果条件满足，可以执行某些操作
-        // 例如：自动改变状态
-        for (const auto& TargetState : TargetNodeStates)
-        {
-            ChangeTargetNodeState(TargetState.Key, TargetState.Value);
-        }
+        ApplyTargetNodeStates();
+    }
+}
+
+void UStateCapability::ApplyTargetNodeStates()
+{
+    // 如果条件满足，可以执行某些操作
+    // 例如：自动改变状态
+    for (const auto& TargetState : TargetNodeStates)
+    {
+        ChangeTargetNodeState(TargetState.Key, TargetState.Value);
+    }
+}
+
+bool UStateCapability::IsStateCheckDue(double WorldTime) const
+{
+    return bAutoCheckState && StateCheckInterval > 0.0f && WorldTime >= NextStateCheckTime;
+}
+
+void UStateCapability::CommitStateCheck(double WorldTime, bool bConditionsMet)
+{
+    NextStateCheckTime = WorldTime + StateCheckInterval;
+    if (bConditionsMet)
+    {
+        ApplyTargetNodeStates();
     }
 }
\ No newline at end of file
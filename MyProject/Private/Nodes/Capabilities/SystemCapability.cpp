@@ -82,6 +82,9 @@ void USystemCapability::BeginPlay()
 {
     Super::BeginPlay();
     
+    // 编辑器中配置的条件在开始运行时解析一次
+    RebuildCompiledConditions();
+    
     // 启动自动条件评估
     if (bAutoEvaluateConditions && ConditionCheckInterval > 0.0f)
     {
@@ -272,13 +275,16 @@ void USystemCapability::RestoreNormalTime()
 
 bool USystemCapability::EvaluateCondition(const FString& ConditionID)
 {
-    if (!ConditionRules.Contains(ConditionID))
+    const FString* Rule = ConditionRules.Find(ConditionID);
+    if (!Rule)
     {
         return false;
     }
     
-    FString Rule = ConditionRules[ConditionID];
-    bool bResult = EvaluateConditionRule(Rule);
+    // 规则在添加时已解析；蓝图直接写入ConditionRules的条件在首次评估时解析
+    const int32* Found = CompiledConditionIndices.Find(FName(*ConditionID));
+    const int32 Index = Found ? *Found : CompileCondition(ConditionID, *Rule);
+    bool bResult = EvaluateCompiledCondition(CompiledConditions[Index]);
     
     ConditionStates.Add(ConditionID, bResult);
     
@@ -289,6 +295,7 @@ void USystemCapability::AddCondition(const FString& ConditionID, const FString&
 {
     ConditionRules.Add(ConditionID, Rule);
     ConditionStates.Add(ConditionID, false);
+    CompileCondition(ConditionID, Rule);
 }
 
 void USystemCapability::SetConditionState(const FString& ConditionID, bool bState)
@@ -307,9 +314,14 @@ bool USystemCapability::GetConditionState(const FString& ConditionID) const
 
 void USystemCapability::EvaluateAllConditions()
 {
-    for (const auto& Condition : ConditionRules)
+    if (CompiledConditions.Num() != ConditionRules.Num())
+    {
+        RebuildCompiledConditions();
+    }
+
+    for (FCompiledConditionRule& Condition : CompiledConditions)
     {
-        EvaluateCondition(Condition.Key);
+        ConditionStates.Add(Condition.ConditionID, EvaluateCompiledCondition(Condition));
     }
 }
 
@@ -537,13 +549,7 @@ AInteractiveNode* USystemCapability::GenerateNode(const FString& TemplateID, con
     }
     
     // 创建节点数据
-    FNodeGenerateData GenerateData;
-    GenerateData.NodeData.NodeID = FString::Printf(TEXT("Generated_%s_%d"), *TemplateID, FDateTime::Now().GetTicks());
-    GenerateData.NodeData.NodeName = TemplateID;
-    GenerateData.NodeData.NodeType = ENodeType::Custom;
-    GenerateData.NodeData.InitialState = ENodeState::Active;
-    GenerateData.NodeClass = NodeTemplates[TemplateID];
-    GenerateData.SpawnTransform.SetLocation(Location);
+    FNodeGenerateData GenerateData = MakeTemplateGenerateData(TemplateID, Location, 0);
     
     AInteractiveNode* NewNode = SystemManager->CreateNode(GenerateData.NodeClass, GenerateData);
     if (NewNode)
@@ -561,19 +567,57 @@ TArray<AInteractiveNode*> USystemCapability::GenerateNodeCluster(const FString&
 {
     TArray<AInteractiveNode*> Cluster;
     
-    for (int32 i = 0; i < Count; i++)
+    if (!NodeTemplates.Contains(TemplateID))
     {
-        FVector Location = GenerateRandomLocation();
-        AInteractiveNode* Node = GenerateNode(TemplateID, Location);
-        if (Node)
-        {
-            Cluster.Add(Node);
-        }
+        UE_LOG(LogTemp, Warning, TEXT("SystemCapability: Template %s not found"), *TemplateID);
+        return Cluster;
     }
     
+    ANodeSystemManager* SystemManager = GetNodeSystemManager();
+    if (!SystemManager)
+    {
+        return Cluster;
+    }
+    
+    const int32 BatchCount = FMath::Min(Count, MaxGeneratedNodes - GeneratedNodes.Num());
+    if (BatchCount < Count)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SystemCapability: Maximum generated nodes reached"));
+    }
+    if (BatchCount <= 0)
+    {
+        return Cluster;
+    }
+    
+    // 整批交给系统管理器，只注册和广播一次
+    TArray<FNodeGenerateData> GenerateDataList;
+    GenerateDataList.Reserve(BatchCount);
+    for (int32 i = 0; i < BatchCount; i++)
+    {
+        GenerateDataList.Add(MakeTemplateGenerateData(TemplateID, GenerateRandomLocation(), i));
+    }
+    
+    Cluster = SystemManager->CreateNodes(GenerateDataList);
+    GeneratedNodes.Append(Cluster);
+    
+    UE_LOG(LogTemp, Log, TEXT("SystemCapability: Generated cluster of %d %s nodes"), Cluster.Num(), *TemplateID);
+    
     return Cluster;
 }
 
+FNodeGenerateData USystemCapability::MakeTemplateGenerateData(const FString& TemplateID, const FVector& Location, int32 BatchIndex) const
+{
+    // 同一帧内批量生成时时间戳相同，附加批内序号保证ID唯一
+    FNodeGenerateData GenerateData;
+    GenerateData.NodeData.NodeID = FString::Printf(TEXT("Generated_%s_%lld_%d"), *TemplateID, FDateTime::Now().GetTicks(), BatchIndex);
+    GenerateData.NodeData.NodeName = TemplateID;
+    GenerateData.NodeData.NodeType = ENodeType::Custom;
+    GenerateData.NodeData.InitialState = ENodeState::Active;
+    GenerateData.NodeClass = NodeTemplates.FindRef(TemplateID);
+    GenerateData.SpawnTransform.SetLocation(Location);
+    return GenerateData;
+}
+
 void USystemCapability::RegisterNodeTemplate(const FString& TemplateID, TSubclassOf<AInteractiveNode> NodeClass)
 {
     if (NodeClass)
@@ -675,12 +719,14 @@ void USystemCapability::UpdateTimeControl(float DeltaTime)
     }
 }
 
-bool USystemCapability::EvaluateConditionRule(const FString& Rule) const
+void USystemCapability::CompileConditionRule(const FString& Rule, FCompiledConditionRule& OutCondition)
 {
-    // 简单的条件评估实现
+    // 简单的条件解析实现
     // 可以扩展为更复杂的表达式解析
+    OutCondition.Kind = EConditionRuleKind::Invalid;
+    OutCondition.NodeHandle = FNodeHandle();
     
-    // 检查节点状态条件
+    // 节点状态条件
     if (Rule.StartsWith(TEXT("NodeState:")))
     {
         FString Condition = Rule.RightChop(10);
@@ -689,28 +735,18 @@ bool USystemCapability::EvaluateConditionRule(const FString& Rule) const
         
         if (Parts.Num() == 2)
         {
-            FString NodeID = Parts[0].TrimStartAndEnd();
-            FString StateStr = Parts[1].TrimStartAndEnd();
-            
-            ANodeSystemManager* SystemManager = GetNodeSystemManager();
-            if (SystemManager)
-            {
-                AInteractiveNode* Node = SystemManager->GetNode(NodeID);
-                if (Node)
-                {
-                    ENodeState RequiredState = static_cast<ENodeState>(FCString::Atoi(*StateStr));
-                    return Node->GetNodeState() == RequiredState;
-                }
-            }
+            OutCondition.Kind = EConditionRuleKind::NodeState;
+            OutCondition.NodeID = Parts[0].TrimStartAndEnd();
+            OutCondition.RequiredState = static_cast<ENodeState>(FCString::Atoi(*Parts[1].TrimStartAndEnd()));
         }
     }
-    // 检查概率条件
+    // 概率条件
     else if (Rule.StartsWith(TEXT("Probability:")))
     {
-        FString EventID = Rule.RightChop(12);
-        return RollProbability(EventID);
+        OutCondition.Kind = EConditionRuleKind::Probability;
+        OutCondition.EventID = Rule.RightChop(12);
     }
-    // 检查数值比较
+    // 数值比较（两侧都是常量）
     else if (Rule.Contains(TEXT(">")))
     {
         TArray<FString> Parts;
@@ -720,11 +756,66 @@ bool USystemCapability::EvaluateConditionRule(const FString& Rule) const
         {
             float Left = FCString::Atof(*Parts[0].TrimStartAndEnd());
             float Right = FCString::Atof(*Parts[1].TrimStartAndEnd());
-            return Left > Right;
+            OutCondition.Kind = EConditionRuleKind::Constant;
+            OutCondition.bConstantResult = Left > Right;
         }
     }
-    
-    return false;
+}
+
+bool USystemCapability::EvaluateCompiledCondition(FCompiledConditionRule& Condition) const
+{
+    switch (Condition.Kind)
+    {
+    case EConditionRuleKind::NodeState:
+        if (ANodeSystemManager* SystemManager = GetNodeSystemManager())
+        {
+            AInteractiveNode* Node = SystemManager->ResolveNode(Condition.NodeID, Condition.NodeHandle);
+            if (Node)
+            {
+                return Node->GetNodeState() == Condition.RequiredState;
+            }
+        }
+        return false;
+        
+    case EConditionRuleKind::Probability:
+        return RollProbability(Condition.EventID);
+        
+    case EConditionRuleKind::Constant:
+        return Condition.bConstantResult;
+        
+    default:
+        return false;
+    }
+}
+
+int32 USystemCapability::CompileCondition(const FString& ConditionID, const FString& Rule)
+{
+    const FName Key(*ConditionID);
+    int32 Index = INDEX_NONE;
+    if (const int32* Existing = CompiledConditionIndices.Find(Key))
+    {
+        Index = *Existing;
+    }
+    else
+    {
+        Index = CompiledConditions.AddDefaulted();
+        CompiledConditionIndices.Add(Key, Index);
+    }
+
+    FCompiledConditionRule& Condition = CompiledConditions[Index];
+    Condition.ConditionID = ConditionID;
+    CompileConditionRule(Rule, Condition);
+    return Index;
+}
+
+void USystemCapability::RebuildCompiledConditions()
+{
+    CompiledConditions.Reset(ConditionRules.Num());
+    CompiledConditionIndices.Reset();
+    for (const auto& Condition : ConditionRules)
+    {
+        CompileCondition(Condition.Key, Condition.Value);
+    }
 }
 
 FVector USystemCapability::GenerateRandomLocation() const
@@ -5,8 +5,7 @@
 #include "Blueprint/UserWidget.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
-#include "Kismet/GameplayStatics.h"
-#include "TimerManager.h"
+#include "GameFramework/Pawn.h"
 
 AInteractiveNode::AInteractiveNode()
 {
@@ -39,6 +38,7 @@ AInteractiveNode::AInteractiveNode()
     bIsInteractable = true;
     InteractionRange = 100000.0f;
     UIDisplayDistance = 1000.0f;
+    UIHideDistanceScale = 1.15f;
     bAlwaysShowUI = false;
     CurrentState = ENodeState::Inactive;
 }
@@ -56,20 +56,11 @@ void AInteractiveNode::BeginPlay()
     // 创建UI
     CreateNodeUI();
 
-    // 开始UI可见性检查
-    if (!bAlwaysShowUI)
-    {
-        GetWorld()->GetTimerManager().SetTimer(
-            UIUpdateTimerHandle,
-            this,
-            &AInteractiveNode::CheckUIVisibility,
-            0.2f,
-            true
-        );
-    }
-    else
+    // 按距离显示的UI由NodeSystemManager的UI可见性服务统一判断
+    if (bAlwaysShowUI)
     {
-        SetUIVisibility(true);
+        bUIShown = true;
+        ShowNodeUI();
     }
 
     UpdateVisuals();
@@ -77,12 +68,6 @@ void AInteractiveNode::BeginPlay()
 
 void AInteractiveNode::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    // 清理定时器
-    if (UIUpdateTimerHandle.IsValid())
-    {
-        GetWorld()->GetTimerManager().ClearTimer(UIUpdateTimerHandle);
-    }
-
     Super::EndPlay(EndPlayReason);
 }
 
@@ -184,6 +169,16 @@ void AInteractiveNode::SetUIVisibility(bool bVisible)
     }
 }
 
+void AInteractiveNode::ShowNodeUI_Implementation()
+{
+    SetUIVisibility(true);
+}
+
+void AInteractiveNode::HideNodeUI_Implementation()
+{
+    SetUIVisibility(false);
+}
+
 FText AInteractiveNode::GetInteractionPrompt_Implementation() const
 {
     return FText::FromString(FString::Printf(TEXT("Interact with %s"), *NodeData.NodeName));
@@ -201,12 +196,12 @@ bool AInteractiveNode::ShouldShowUI_Implementation(APlayerController* Player) co
         return true;
     }
 
-    // 检查距离
+    // 检查距离，已显示时放宽到隐藏距离
     APawn* PlayerPawn = Player->GetPawn();
     if (PlayerPawn)
     {
-        float Distance = FVector::Dist(GetActorLocation(), PlayerPawn->GetActorLocation());
-        return Distance <= UIDisplayDistance;
+        const float MaxDistance = bUIShown ? UIDisplayDistance * UIHideDistanceScale : UIDisplayDistance;
+        return FVector::DistSquared(GetActorLocation(), PlayerPawn->GetActorLocation()) <= FMath::Square(MaxDistance);
     }
 
     return false;
@@ -275,11 +270,13 @@ bool AInteractiveNode::ValidateInteraction_Implementation(const FInteractionData
 
 void AInteractiveNode::BroadcastStateChange(ENodeState OldState, ENodeState NewState)
 {
+    OnNodeStateChangedNative.Broadcast(this, OldState, NewState);
     OnNodeStateChanged.Broadcast(this, OldState, NewState);
 }
 
 void AInteractiveNode::BroadcastInteraction(const FInteractionData& Data)
 {
+    OnNodeInteractedNative.Broadcast(this, Data);
     OnNodeInteracted.Broadcast(this, Data);
 }
 
@@ -328,12 +325,47 @@ void AInteractiveNode::CreateNodeUI()
     }
 }
 
-void AInteractiveNode::CheckUIVisibility()
+void AInteractiveNode::ApplySignificanceTier(ENodeSignificanceTier Tier)
 {
-    APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-    if (PC)
+    if (Tier == SignificanceTier)
+    {
+        return;
+    }
+
+    if (SignificanceTier == ENodeSignificanceTier::Full)
     {
-        bool bShouldShow = ShouldShowUI(PC);
-        SetUIVisibility(bShouldShow);
+        bCollisionEnabledAtFull = GetActorEnableCollision();
+        bActorTickEnabledAtFull = IsActorTickEnabled();
+        bWidgetTickEnabledAtFull = InfoWidgetComponent && InfoWidgetComponent->IsComponentTickEnabled();
     }
+    SignificanceTier = Tier;
+
+    // Hidden状态的节点保持隐藏
+    if (NodeMesh)
+    {
+        NodeMesh->SetVisibility(Tier != ENodeSignificanceTier::Dormant && CurrentState != ENodeState::Hidden);
+    }
+
+    SetActorEnableCollision(Tier <= ENodeSignificanceTier::Reduced && bCollisionEnabledAtFull);
+
+    // UI组件只在Full层级显示和Tick；常显UI在回到Full时恢复，其余由UI可见性服务决定
+    const bool bFullTier = Tier == ENodeSignificanceTier::Full;
+    if (InfoWidgetComponent)
+    {
+        InfoWidgetComponent->SetComponentTickEnabled(bFullTier && bWidgetTickEnabledAtFull);
+    }
+    if (bUIShown != bFullTier && (!bFullTier || bAlwaysShowUI))
+    {
+        bUIShown = bFullTier;
+        if (bFullTier)
+        {
+            ShowNodeUI();
+        }
+        else
+        {
+            HideNodeUI();
+        }
+    }
+
+    SetActorTickEnabled(bFullTier && bActorTickEnabledAtFull);
 }
\ No newline at end of file
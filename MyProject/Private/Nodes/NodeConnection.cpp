@@ -3,7 +3,10 @@
 // NodeConnection.cpp
 #include "Nodes/NodeConnection.h"
 #include "Nodes/InteractiveNode.h"
+#include "Nodes/NodeSystemManager.h"
+#include "Nodes/NodeConnectionRenderer.h"
 #include "Components/WidgetComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "Engine/World.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
@@ -13,24 +16,11 @@ ANodeConnection::ANodeConnection()
     PrimaryActorTick.bCanEverTick = true;
     PrimaryActorTick.bStartWithTickEnabled = false;
 
-    // 创建根组件
+    // 创建根组件，网格和信息UI组件在使用Actor表现时才创建
     RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
-
-    // 创建连接网格
-    ConnectionMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ConnectionMesh"));
-    ConnectionMesh->SetupAttachment(RootComponent);
-    ConnectionMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-    ConnectionMesh->SetCastShadow(false);
-
-    // 创建特效组件
-
-
-    // 创建信息UI组件
-    ConnectionInfoWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("ConnectionInfoWidget"));
-    ConnectionInfoWidget->SetupAttachment(RootComponent);
-    ConnectionInfoWidget->SetWidgetSpace(EWidgetSpace::Screen);
-    ConnectionInfoWidget->SetDrawSize(FVector2D(150.0f, 50.0f));
-    ConnectionInfoWidget->SetVisibility(false);
+    ConnectionMesh = nullptr;
+    ConnectionInfoWidget = nullptr;
+    bUseActorVisuals = false;
 
     // 默认值
     RelationType = ENodeRelationType::Dependency;
@@ -38,6 +28,17 @@ ANodeConnection::ANodeConnection()
     bIsActive = true;
     bIsBidirectional = false;
     ConnectionStrength = 1.0f;
+    SystemManager = nullptr;
+    InstancedRenderer = nullptr;
+    RenderBatchIndex = INDEX_NONE;
+    RenderInstanceIndex = INDEX_NONE;
+    bInstanceVisible = false;
+    bTransformDirty = false;
+    ActorBaseMaterial = nullptr;
+    ConnectionMaterialInstance = nullptr;
+    AppliedMaterialColor = FLinearColor::Transparent;
+    bHasAppliedMaterialColor = false;
+    bRemovedFromSystem = false;
     ActivationDelay = 0.0f;
 
     // 视觉默认值
@@ -45,15 +46,20 @@ ANodeConnection::ANodeConnection()
     ActiveColor = FLinearColor(0.0f, 0.8f, 1.0f, 1.0f);
     ConnectionThickness = 0.2f;
     bAnimateConnection = false;
-    CurrentAnimationTime = 0.0f;
+    AnimationSpeed = 1.0f;
+    PulseColor = FLinearColor::White;
+    AnimationStartTime = 0.0f;
+    AnimationFromColor = BaseColor;
     bIsAnimating = false;
+    AppliedAnimationStartTime = -1.0f;
+    SignificanceTier = ENodeSignificanceTier::Full;
+    bWidgetTickEnabledAtFull = true;
 
     // 设置默认网格
     static ConstructorHelpers::FObjectFinder<UStaticMesh> DefaultMesh(TEXT("/Engine/BasicShapes/Cylinder"));
     if (DefaultMesh.Succeeded())
     {
         VisualData.ConnectionMesh = DefaultMesh.Object;
-        ConnectionMesh->SetStaticMesh(VisualData.ConnectionMesh);
     }
 }
 
@@ -89,6 +95,11 @@ void ANodeConnection::EndPlay(const EEndPlayReason::Type EndPlayReason)
     // 注销事件
     UnregisterNodeEvents();
 
+    if (InstancedRenderer)
+    {
+        InstancedRenderer->RemoveConnection(this);
+    }
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -96,14 +107,10 @@ void ANodeConnection::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
-    // 更新连接位置
-    UpdateConnection();
-
-    // 更新动画
-    if (bIsAnimating && bAnimateConnection)
+    // 只有没有管理器的连接会Tick，自行跟随端点；有管理器时变换由其按脏标记每帧批量更新
+    if (!SystemManager)
     {
-        CurrentAnimationTime += DeltaTime;
-        UpdateVisuals();
+        UpdateConnection();
     }
 }
 
@@ -202,21 +209,80 @@ void ANodeConnection::Activate()
     }
 
     bIsActive = true;
-    bIsAnimating = true;
-    CurrentAnimationTime = 0.0f;
 
-    // 启用Tick进行动画
-    if (bAnimateConnection)
+    // 没有管理器的连接需要Tick跟随端点
+    if (!SystemManager)
     {
         SetActorTickEnabled(true);
     }
 
-    UpdateVisuals();
+    // 从BaseColor过渡到激活颜色
+    if (bAnimateConnection && SignificanceTier == ENodeSignificanceTier::Full)
+    {
+        StartAnimation(BaseColor);
+    }
+    else
+    {
+        UpdateVisuals();
+    }
     OnConnectionActivated.Broadcast(this);
 
     UE_LOG(LogTemp, Log, TEXT("NodeConnection %s activated"), *ConnectionID);
 }
 
+void ANodeConnection::Pulse()
+{
+    if (bAnimateConnection && SignificanceTier == ENodeSignificanceTier::Full)
+    {
+        StartAnimation(PulseColor);
+    }
+
+    // 事件按动画时长一次性调度，每次脉冲各自广播
+    const float Duration = AnimationSpeed > 0.0f ? 1.0f / AnimationSpeed : 0.0f;
+    UWorld* World = GetWorld();
+    if (World && Duration > 0.0f)
+    {
+        FTimerHandle PulseHandle;
+        World->GetTimerManager().SetTimer(PulseHandle, FTimerDelegate::CreateUObject(this, &ANodeConnection::BroadcastPulse), Duration, false);
+    }
+    else
+    {
+        BroadcastPulse();
+    }
+}
+
+void ANodeConnection::BroadcastPulse()
+{
+    OnConnectionPulsed.Broadcast(this);
+}
+
+void ANodeConnection::StartAnimation(const FLinearColor& FromColor)
+{
+    const UWorld* World = GetWorld();
+    AnimationStartTime = World ? World->GetTimeSeconds() : 0.0f;
+    AnimationFromColor = FromColor;
+
+    // 动画播放完毕后回到静态表现（共享材质、实例速度0）；重复开始会重新计时
+    const float Duration = AnimationSpeed > 0.0f ? 1.0f / AnimationSpeed : 0.0f;
+    bIsAnimating = World && Duration > 0.0f;
+    if (bIsAnimating)
+    {
+        World->GetTimerManager().SetTimer(AnimationTimerHandle, FTimerDelegate::CreateUObject(this, &ANodeConnection::FinishAnimation), Duration, false);
+    }
+    UpdateVisuals();
+}
+
+void ANodeConnection::FinishAnimation()
+{
+    if (!bIsAnimating)
+    {
+        return;
+    }
+
+    bIsAnimating = false;
+    UpdateVisuals();
+}
+
 void ANodeConnection::Deactivate()
 {
     if (!bIsActive)
@@ -226,6 +292,10 @@ void ANodeConnection::Deactivate()
 
     bIsActive = false;
     bIsAnimating = false;
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(AnimationTimerHandle);
+    }
 
     // 禁用Tick
     SetActorTickEnabled(false);
@@ -243,37 +313,51 @@ void ANodeConnection::UpdateConnection()
         return;
     }
 
-    FVector StartPoint, EndPoint;
-    CalculateConnectionPoints(StartPoint, EndPoint);
+    // 实例化渲染：只改写对应实例
+    if (InstancedRenderer)
+    {
+        InstancedRenderer->UpdateConnectionTransform(this);
+        return;
+    }
+
+    if (!ShouldUseActorVisuals())
+    {
+        return;
+    }
+    CreateActorVisuals();
 
-    // 设置位置为中点
-    FVector MidPoint = (StartPoint + EndPoint) * 0.5f;
-    SetActorLocation(MidPoint);
+    ApplyConnectionTransform(GetConnectionTransform());
+}
 
-    // 计算旋转
-    FVector Direction = (EndPoint - StartPoint).GetSafeNormal();
-    FRotator Rotation = UKismetMathLibrary::MakeRotFromX(Direction);
-    SetActorRotation(Rotation);
+void ANodeConnection::ApplyConnectionTransform(const FTransform& ConnectionTransform)
+{
+    CreateActorVisuals();
+
+    SetActorLocationAndRotation(ConnectionTransform.GetLocation(), ConnectionTransform.GetRotation());
 
-    // 计算缩放
-    float Distance = FVector::Dist(StartPoint, EndPoint);
     if (ConnectionMesh && VisualData.bScaleByDistance)
     {
-        float ScaleFactor = FMath::GetMappedRangeValueClamped(
-            FVector2D(100.0f, 2000.0f),
-            FVector2D(VisualData.MinScale, VisualData.MaxScale),
-            Distance
-        );
-        
-        FVector NewScale = VisualData.MeshScale;
-        NewScale.X *= Distance / 100.0f; // 假设默认网格长度为100
-        NewScale.Y *= ConnectionThickness;//ScaleFactor * ConnectionThickness;
-        NewScale.Z *= ConnectionThickness;//ScaleFactor * ConnectionThickness;
-        
-        ConnectionMesh->SetRelativeScale3D(NewScale);
+        ConnectionMesh->SetRelativeScale3D(ConnectionTransform.GetScale3D());
     }
 }
 
+FTransform ANodeConnection::GetConnectionTransform() const
+{
+    FVector StartPoint, EndPoint;
+    CalculateConnectionPoints(StartPoint, EndPoint);
+
+    FVector Scale = VisualData.MeshScale;
+    if (VisualData.bScaleByDistance)
+    {
+        Scale.X *= FVector::Dist(StartPoint, EndPoint) / 100.0f; // 假设默认网格长度为100
+        Scale.Y *= ConnectionThickness;
+        Scale.Z *= ConnectionThickness;
+    }
+
+    const FRotator Rotation = UKismetMathLibrary::MakeRotFromX((EndPoint - StartPoint).GetSafeNormal());
+    return FTransform(Rotation, (StartPoint + EndPoint) * 0.5f, Scale);
+}
+
 bool ANodeConnection::CanPropagateState_Implementation(ENodeState State) const
 {
     if (!IsValid() || !bIsActive)
@@ -346,10 +430,9 @@ void ANodeConnection::PropagateState(AInteractiveNode* FromNode, ENodeState NewS
     {
     case ENodeRelationType::Dependency:
     case ENodeRelationType::Prerequisite:
-        if (FromNode == SourceNode && NewState == ENodeState::Completed)
+        // 有管理器时由其在源节点完成时统一解锁（Prerequisite按计数，Dependency按前置是否满足）
+        if (!SystemManager && FromNode == SourceNode && NewState == ENodeState::Completed)
         {
-            // 检查目标节点的所有前置条件
-            // 这里简化处理，实际应该由NodeSystemManager统一管理
             if (ToNode->GetNodeState() == ENodeState::Locked)
             {
                 ToNode->SetNodeState(ENodeState::Active);
@@ -360,7 +443,7 @@ void ANodeConnection::PropagateState(AInteractiveNode* FromNode, ENodeState NewS
     case ENodeRelationType::Trigger:
         if (FromNode == SourceNode && NewState == ENodeState::Active)
         {
-            ToNode->SetNodeState(ENodeState::Active);
+            ApplyPropagatedState(FromNode, ToNode, ENodeState::Active);
         }
         break;
         
@@ -368,14 +451,14 @@ void ANodeConnection::PropagateState(AInteractiveNode* FromNode, ENodeState NewS
         // 父子关系可能需要特殊处理
         if (PropagationStrength >= 0.5f) // 只有足够强的连接才传播
         {
-            ToNode->SetNodeState(NewState);
+            ApplyPropagatedState(FromNode, ToNode, NewState);
         }
         break;
         
     case ENodeRelationType::Sequence:
         if (FromNode == SourceNode && NewState == ENodeState::Completed)
         {
-            ToNode->SetNodeState(ENodeState::Active);
+            ApplyPropagatedState(FromNode, ToNode, ENodeState::Active);
         }
         break;
     }
@@ -384,6 +467,19 @@ void ANodeConnection::PropagateState(AInteractiveNode* FromNode, ENodeState NewS
         *ConnectionID, (int32)NewState, *FromNode->GetNodeName(), *ToNode->GetNodeName());
 }
 
+void ANodeConnection::ApplyPropagatedState(AInteractiveNode* FromNode, AInteractiveNode* ToNode, ENodeState NewState)
+{
+    // 经管理器的工作表应用，避免沿图同步递归
+    if (SystemManager)
+    {
+        SystemManager->RequestNodeState(ToNode, NewState, FromNode, this);
+    }
+    else
+    {
+        ToNode->SetNodeState(NewState);
+    }
+}
+
 void ANodeConnection::PropagateInteraction(AInteractiveNode* FromNode, const FInteractionData& Data)
 {
     if (!CanPropagateInteraction())
@@ -449,38 +545,124 @@ FText ANodeConnection::GetConnectionDescription_Implementation() const
 
 bool ANodeConnection::ShouldShowConnection_Implementation() const
 {
-    return IsValid() && bIsActive;
+    return IsValid() && bIsActive && SignificanceTier != ENodeSignificanceTier::Dormant;
 }
 
 void ANodeConnection::UpdateVisuals_Implementation()
 {
-    if (!ConnectionMesh)
+    // 实例化渲染：颜色写入实例自定义数据，可见性体现为实例缩放
+    if (InstancedRenderer)
+    {
+        InstancedRenderer->UpdateConnectionVisuals(this);
+        return;
+    }
+
+    if (!ShouldUseActorVisuals())
     {
         return;
     }
+    CreateActorVisuals();
 
     // 设置颜色
-    FLinearColor CurrentColor = GetConnectionColor();
-    
-    // 如果正在动画，插值颜色
-    if (bIsAnimating && bAnimateConnection)
+    const FLinearColor CurrentColor = GetDisplayColor();
+
+    // 静态连接优先使用按关系类型和激活状态共享的材质，正在播放动画的连接需要自有的动画参数
+    UMaterialInterface* Material = nullptr;
+    if (!bIsAnimating && SystemManager && SystemManager->ConnectionRenderer)
     {
-        float Alpha = FMath::Clamp(CurrentAnimationTime / 1.0f, 0.0f, 1.0f);
-        CurrentColor = FLinearColor::LerpUsingHSV(BaseColor, CurrentColor, Alpha);
+        Material = SystemManager->ConnectionRenderer->GetSharedMaterial(ActorBaseMaterial, RelationType, bIsActive, CurrentColor);
     }
 
-    // 创建动态材质实例
-    UMaterialInstanceDynamic* DynMaterial = ConnectionMesh->CreateAndSetMaterialInstanceDynamic(0);
-    if (DynMaterial)
+    // 否则使用自有材质实例，只创建一次，颜色变化时才写参数
+    if (!Material && ActorBaseMaterial)
     {
-        DynMaterial->SetVectorParameterValue(TEXT("BaseColor"), CurrentColor);
-        DynMaterial->SetScalarParameterValue(TEXT("Opacity"), CurrentColor.A);
+        if (!ConnectionMaterialInstance)
+        {
+            ConnectionMaterialInstance = UMaterialInstanceDynamic::Create(ActorBaseMaterial, this);
+        }
+
+        if (!bHasAppliedMaterialColor || !AppliedMaterialColor.Equals(CurrentColor))
+        {
+            ConnectionMaterialInstance->SetVectorParameterValue(UNodeConnectionRenderer::ColorParameterName, CurrentColor);
+            ConnectionMaterialInstance->SetScalarParameterValue(UNodeConnectionRenderer::OpacityParameterName, CurrentColor.A);
+            AppliedMaterialColor = CurrentColor;
+            bHasAppliedMaterialColor = true;
+        }
+
+        // 动画参数只在新动画开始时写入一次
+        const float StartTime = bIsAnimating ? AnimationStartTime : -1.0f;
+        if (StartTime != AppliedAnimationStartTime)
+        {
+            ConnectionMaterialInstance->SetVectorParameterValue(UNodeConnectionRenderer::AnimationColorParameterName, AnimationFromColor);
+            ConnectionMaterialInstance->SetScalarParameterValue(UNodeConnectionRenderer::AnimationStartTimeParameterName, AnimationStartTime);
+            ConnectionMaterialInstance->SetScalarParameterValue(UNodeConnectionRenderer::AnimationSpeedParameterName, bIsAnimating ? AnimationSpeed : 0.0f);
+            AppliedAnimationStartTime = StartTime;
+        }
+        Material = ConnectionMaterialInstance;
+    }
+
+    if (Material && ConnectionMesh->GetMaterial(0) != Material)
+    {
+        ConnectionMesh->SetMaterial(0, Material);
     }
 
     // 更新可见性
     ConnectionMesh->SetVisibility(ShouldShowConnection());
 }
 
+void ANodeConnection::ApplySignificanceTier(ENodeSignificanceTier Tier)
+{
+    if (Tier == SignificanceTier)
+    {
+        return;
+    }
+
+    if (SignificanceTier == ENodeSignificanceTier::Full)
+    {
+        bWidgetTickEnabledAtFull = ConnectionInfoWidget && ConnectionInfoWidget->IsComponentTickEnabled();
+    }
+    SignificanceTier = Tier;
+
+    // 动画由材质按世界时间播放，不占用Tick；降级只影响之后是否开始新的动画
+    if (ConnectionInfoWidget)
+    {
+        ConnectionInfoWidget->SetComponentTickEnabled(Tier == ENodeSignificanceTier::Full && bWidgetTickEnabledAtFull);
+    }
+
+    // 可见性随ShouldShowConnection变化：实例化连接改写实例缩放，Actor表现切换网格可见性
+    UpdateVisuals();
+}
+
+FLinearColor ANodeConnection::GetDisplayColor() const
+{
+    return GetConnectionColor();
+}
+
+void ANodeConnection::CreateActorVisuals()
+{
+    if (ConnectionMesh)
+    {
+        return;
+    }
+
+    // 创建连接网格
+    ConnectionMesh = NewObject<UStaticMeshComponent>(this, TEXT("ConnectionMesh"));
+    ConnectionMesh->SetupAttachment(RootComponent);
+    ConnectionMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    ConnectionMesh->SetCastShadow(false);
+    ConnectionMesh->SetStaticMesh(VisualData.ConnectionMesh);
+    ConnectionMesh->RegisterComponent();
+    ActorBaseMaterial = ConnectionMesh->GetMaterial(0);
+
+    // 创建信息UI组件
+    ConnectionInfoWidget = NewObject<UWidgetComponent>(this, TEXT("ConnectionInfoWidget"));
+    ConnectionInfoWidget->SetupAttachment(RootComponent);
+    ConnectionInfoWidget->SetWidgetSpace(EWidgetSpace::Screen);
+    ConnectionInfoWidget->SetDrawSize(FVector2D(150.0f, 50.0f));
+    ConnectionInfoWidget->SetVisibility(false);
+    ConnectionInfoWidget->RegisterComponent();
+}
+
 void ANodeConnection::UpdateEffects_Implementation()
 {
 
@@ -535,7 +717,7 @@ void ANodeConnection::OnNodeInteracted(AInteractiveNode* Node, const FInteractio
     }
 
     // 触发视觉反馈
-    OnConnectionPulsed.Broadcast(this);
+    Pulse();
 
     // 可能传播交互
     if (CanPropagateInteraction())
@@ -555,19 +737,28 @@ void ANodeConnection::OnNodeDestroyed(AActor* DestroyedActor)
 
 void ANodeConnection::RegisterNodeEvents()
 {
+    // 有管理器时状态和交互事件由管理器分发，只需监听销毁
+    const bool bBindNodeEvents = SystemManager == nullptr;
+
     if (SourceNode)
     {
-        SourceNode->OnNodeStateChanged.AddDynamic(this, &ANodeConnection::OnSourceNodeStateChanged);
-        SourceNode->OnNodeInteracted.AddDynamic(this, &ANodeConnection::OnNodeInteracted);
+        if (bBindNodeEvents)
+        {
+            SourceNode->OnNodeStateChangedNative.AddUObject(this, &ANodeConnection::OnSourceNodeStateChanged);
+            SourceNode->OnNodeInteractedNative.AddUObject(this, &ANodeConnection::OnNodeInteracted);
+        }
         SourceNode->OnDestroyed.AddDynamic(this, &ANodeConnection::OnNodeDestroyed);
     }
 
     if (TargetNode)
     {
-        TargetNode->OnNodeStateChanged.AddDynamic(this, &ANodeConnection::OnTargetNodeStateChanged);
-        if (bIsBidirectional)
+        if (bBindNodeEvents)
         {
-            TargetNode->OnNodeInteracted.AddDynamic(this, &ANodeConnection::OnNodeInteracted);
+            TargetNode->OnNodeStateChangedNative.AddUObject(this, &ANodeConnection::OnTargetNodeStateChanged);
+            if (bIsBidirectional)
+            {
+                TargetNode->OnNodeInteractedNative.AddUObject(this, &ANodeConnection::OnNodeInteracted);
+            }
         }
         TargetNode->OnDestroyed.AddDynamic(this, &ANodeConnection::OnNodeDestroyed);
     }
@@ -577,22 +768,36 @@ void ANodeConnection::UnregisterNodeEvents()
 {
     if (SourceNode)
     {
-        SourceNode->OnNodeStateChanged.RemoveDynamic(this, &ANodeConnection::OnSourceNodeStateChanged);
-        SourceNode->OnNodeInteracted.RemoveDynamic(this, &ANodeConnection::OnNodeInteracted);
+        SourceNode->OnNodeStateChangedNative.RemoveAll(this);
+        SourceNode->OnNodeInteractedNative.RemoveAll(this);
         SourceNode->OnDestroyed.RemoveDynamic(this, &ANodeConnection::OnNodeDestroyed);
     }
 
     if (TargetNode)
     {
-        TargetNode->OnNodeStateChanged.RemoveDynamic(this, &ANodeConnection::OnTargetNodeStateChanged);
-        if (bIsBidirectional)
-        {
-            TargetNode->OnNodeInteracted.RemoveDynamic(this, &ANodeConnection::OnNodeInteracted);
-        }
+        TargetNode->OnNodeStateChangedNative.RemoveAll(this);
+        TargetNode->OnNodeInteractedNative.RemoveAll(this);
         TargetNode->OnDestroyed.RemoveDynamic(this, &ANodeConnection::OnNodeDestroyed);
     }
 }
 
+void ANodeConnection::NotifyEndpointStateChanged(AInteractiveNode* Node, ENodeState OldState, ENodeState NewState)
+{
+    if (Node == SourceNode || Node == TargetNode)
+    {
+        HandleNodeStateChange(Node, NewState);
+    }
+}
+
+void ANodeConnection::NotifyEndpointInteracted(AInteractiveNode* Node, const FInteractionData& Data)
+{
+    // 与绑定时的规则一致：源节点总是传播，目标节点只在双向连接时传播
+    if (Node == SourceNode || (Node == TargetNode && bIsBidirectional))
+    {
+        OnNodeInteracted(Node, Data);
+    }
+}
+
 bool ANodeConnection::ValidateConnection() const
 {
     return SourceNode != nullptr && TargetNode != nullptr && SourceNode != TargetNode;
@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeConnectionRenderer.cpp
+#include "Nodes/NodeConnectionRenderer.h"
+#include "Nodes/NodeConnection.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "UObject/ConstructorHelpers.h"
+
+const FName UNodeConnectionRenderer::ColorParameterName(TEXT("BaseColor"));
+const FName UNodeConnectionRenderer::OpacityParameterName(TEXT("Opacity"));
+const FName UNodeConnectionRenderer::AnimationColorParameterName(TEXT("AnimationColor"));
+const FName UNodeConnectionRenderer::AnimationStartTimeParameterName(TEXT("AnimationStartTime"));
+const FName UNodeConnectionRenderer::AnimationSpeedParameterName(TEXT("AnimationSpeed"));
+
+UNodeConnectionRenderer::UNodeConnectionRenderer()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+
+    ConnectionMesh = nullptr;
+    DefaultMaterial = nullptr;
+
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> DefaultMesh(TEXT("/Engine/BasicShapes/Cylinder"));
+    if (DefaultMesh.Succeeded())
+    {
+        ConnectionMesh = DefaultMesh.Object;
+    }
+}
+
+void UNodeConnectionRenderer::AddConnection(ANodeConnection* Connection)
+{
+    if (!Connection || Connection->InstancedRenderer)
+    {
+        return;
+    }
+
+    FConnectionBatch& Batch = GetOrCreateBatch(Connection->RelationType);
+    if (!Batch.Mesh)
+    {
+        return;
+    }
+
+    const int32 InstanceIndex = Batch.Mesh->AddInstance(GetInstanceTransform(Connection, Connection->GetConnectionTransform()), true);
+    check(InstanceIndex == Batch.Owners.Num());
+    Batch.Owners.Add(Connection);
+
+    Connection->InstancedRenderer = this;
+    Connection->RenderBatchIndex = static_cast<int32>(Connection->RelationType);
+    Connection->RenderInstanceIndex = InstanceIndex;
+
+    WriteConnectionCustomData(Connection);
+}
+
+void UNodeConnectionRenderer::RemoveConnection(ANodeConnection* Connection)
+{
+    if (!Connection || Connection->InstancedRenderer != this)
+    {
+        return;
+    }
+
+    FConnectionBatch& Batch = Batches[Connection->RenderBatchIndex];
+    const int32 InstanceIndex = Connection->RenderInstanceIndex;
+    const int32 LastIndex = Batch.Owners.Num() - 1;
+
+    // 末尾实例移到空出的位置，只需重写这一个实例
+    if (InstanceIndex != LastIndex)
+    {
+        ANodeConnection* Moved = Batch.Owners[LastIndex];
+        Batch.Owners[InstanceIndex] = Moved;
+        Moved->RenderInstanceIndex = InstanceIndex;
+        UpdateConnectionTransform(Moved);
+        WriteConnectionCustomData(Moved);
+    }
+
+    Batch.Owners.Pop(false);
+    Batch.Mesh->RemoveInstance(LastIndex);
+
+    Connection->InstancedRenderer = nullptr;
+    Connection->RenderBatchIndex = INDEX_NONE;
+    Connection->RenderInstanceIndex = INDEX_NONE;
+}
+
+void UNodeConnectionRenderer::ClearConnections()
+{
+    for (FConnectionBatch& Batch : Batches)
+    {
+        for (ANodeConnection* Connection : Batch.Owners)
+        {
+            Connection->InstancedRenderer = nullptr;
+            Connection->RenderBatchIndex = INDEX_NONE;
+            Connection->RenderInstanceIndex = INDEX_NONE;
+        }
+        Batch.Owners.Reset();
+
+        if (Batch.Mesh)
+        {
+            Batch.Mesh->ClearInstances();
+        }
+    }
+}
+
+void UNodeConnectionRenderer::UpdateConnectionTransform(ANodeConnection* Connection)
+{
+    if (!Connection || Connection->InstancedRenderer != this)
+    {
+        return;
+    }
+
+    Batches[Connection->RenderBatchIndex].Mesh->UpdateInstanceTransform(
+        Connection->RenderInstanceIndex, GetInstanceTransform(Connection, Connection->GetConnectionTransform()), true, true, false);
+}
+
+void UNodeConnectionRenderer::ApplyConnectionTransforms(TConstArrayView<ANodeConnection*> Connections, TConstArrayView<FTransform> Transforms)
+{
+    check(Connections.Num() == Transforms.Num());
+
+    TBitArray<> TouchedBatches(false, Batches.Num());
+    for (int32 Index = 0; Index < Connections.Num(); ++Index)
+    {
+        ANodeConnection* Connection = Connections[Index];
+        if (Connection->InstancedRenderer != this)
+        {
+            continue;
+        }
+
+        Batches[Connection->RenderBatchIndex].Mesh->UpdateInstanceTransform(
+            Connection->RenderInstanceIndex, GetInstanceTransform(Connection, Transforms[Index]), true, false, true);
+        TouchedBatches[Connection->RenderBatchIndex] = true;
+    }
+
+    for (TConstSetBitIterator<> It(TouchedBatches); It; ++It)
+    {
+        Batches[It.GetIndex()].Mesh->MarkRenderStateDirty();
+    }
+}
+
+void UNodeConnectionRenderer::UpdateConnectionVisuals(ANodeConnection* Connection)
+{
+    if (!Connection || Connection->InstancedRenderer != this)
+    {
+        return;
+    }
+
+    if (Connection->bInstanceVisible != Connection->ShouldShowConnection())
+    {
+        UpdateConnectionTransform(Connection);
+    }
+
+    // 与实例当前的自定义数据比较，相同则不标记渲染状态
+    float CustomData[NumCustomDataFloats];
+    BuildCustomData(Connection, CustomData);
+    const UInstancedStaticMeshComponent* Mesh = Batches[Connection->RenderBatchIndex].Mesh;
+    const int32 Offset = Connection->RenderInstanceIndex * NumCustomDataFloats;
+    if (Mesh->PerInstanceSMCustomData.IsValidIndex(Offset + NumCustomDataFloats - 1)
+        && FMemory::Memcmp(&Mesh->PerInstanceSMCustomData[Offset], CustomData, sizeof(CustomData)) == 0)
+    {
+        return;
+    }
+
+    WriteConnectionCustomData(Connection);
+}
+
+void UNodeConnectionRenderer::BuildCustomData(const ANodeConnection* Connection, float (&OutCustomData)[NumCustomDataFloats])
+{
+    const FLinearColor Color = Connection->GetDisplayColor();
+    const FLinearColor& FromColor = Connection->AnimationFromColor;
+    OutCustomData[0] = Color.R;
+    OutCustomData[1] = Color.G;
+    OutCustomData[2] = Color.B;
+    OutCustomData[3] = Color.A;
+    OutCustomData[4] = FromColor.R;
+    OutCustomData[5] = FromColor.G;
+    OutCustomData[6] = FromColor.B;
+    OutCustomData[7] = Connection->AnimationStartTime;
+    OutCustomData[8] = Connection->bIsAnimating ? Connection->AnimationSpeed : 0.0f;
+}
+
+void UNodeConnectionRenderer::WriteConnectionCustomData(ANodeConnection* Connection)
+{
+    float CustomData[NumCustomDataFloats];
+    BuildCustomData(Connection, CustomData);
+    Batches[Connection->RenderBatchIndex].Mesh->SetCustomData(
+        Connection->RenderInstanceIndex, MakeArrayView(CustomData, NumCustomDataFloats), true);
+}
+
+UMaterialInstanceDynamic* UNodeConnectionRenderer::GetSharedMaterial(UMaterialInterface* BaseMaterial, ENodeRelationType RelationType, bool bActive, const FLinearColor& Color)
+{
+    if (!BaseMaterial)
+    {
+        return nullptr;
+    }
+
+    const FSharedMaterialKey Key(BaseMaterial, static_cast<uint8>(RelationType), bActive);
+    if (const FSharedMaterial* Existing = SharedMaterials.Find(Key))
+    {
+        return Existing->Color.Equals(Color) ? Existing->Material : nullptr;
+    }
+
+    UMaterialInstanceDynamic* Material = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+    Material->SetVectorParameterValue(ColorParameterName, Color);
+    Material->SetScalarParameterValue(OpacityParameterName, Color.A);
+
+    FSharedMaterial& Shared = SharedMaterials.Add(Key);
+    Shared.Material = Material;
+    Shared.Color = Color;
+    SharedMaterialRefs.Add(Material);
+    return Material;
+}
+
+int32 UNodeConnectionRenderer::GetInstanceCount() const
+{
+    int32 Count = 0;
+    for (const FConnectionBatch& Batch : Batches)
+    {
+        Count += Batch.Owners.Num();
+    }
+    return Count;
+}
+
+UNodeConnectionRenderer::FConnectionBatch& UNodeConnectionRenderer::GetOrCreateBatch(ENodeRelationType RelationType)
+{
+    const int32 BatchIndex = static_cast<int32>(RelationType);
+    if (Batches.Num() <= BatchIndex)
+    {
+        Batches.SetNum(BatchIndex + 1);
+    }
+
+    FConnectionBatch& Batch = Batches[BatchIndex];
+    if (Batch.Mesh || !GetOwner())
+    {
+        return Batch;
+    }
+
+    // 实例以世界坐标写入，组件本身不跟随管理器移动
+    UInstancedStaticMeshComponent* Mesh = NewObject<UInstancedStaticMeshComponent>(GetOwner());
+    Mesh->SetupAttachment(this);
+    Mesh->SetUsingAbsoluteLocation(true);
+    Mesh->SetUsingAbsoluteRotation(true);
+    Mesh->SetUsingAbsoluteScale(true);
+    Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    Mesh->SetCastShadow(false);
+    Mesh->NumCustomDataFloats = NumCustomDataFloats;
+    Mesh->SetStaticMesh(ConnectionMesh);
+
+    UMaterialInterface* Material = RelationMaterials.FindRef(RelationType);
+    if (!Material)
+    {
+        Material = DefaultMaterial;
+    }
+    if (Material)
+    {
+        Mesh->SetMaterial(0, Material);
+    }
+
+    Mesh->RegisterComponent();
+
+    Batch.Mesh = Mesh;
+    BatchComponents.Add(Mesh);
+    return Batch;
+}
+
+FTransform UNodeConnectionRenderer::GetInstanceTransform(ANodeConnection* Connection, const FTransform& ConnectionTransform)
+{
+    Connection->bInstanceVisible = Connection->ShouldShowConnection();
+
+    FTransform Transform = ConnectionTransform;
+    if (!Connection->bInstanceVisible)
+    {
+        Transform.SetScale3D(FVector::ZeroVector);
+    }
+    return Transform;
+}
@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeGraphDebugRenderer.cpp
+#include "Nodes/NodeGraphDebugRenderer.h"
+#include "Nodes/NodeSystemManager.h"
+#include "Nodes/NodeConnection.h"
+#include "Nodes/InteractiveNode.h"
+#include "Components/LineBatchComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "SceneManagement.h"
+#include "DrawDebugHelpers.h"
+
+static TAutoConsoleVariable<int32> CVarNodeDebugDrawGraph(
+    TEXT("Node.Debug.DrawGraph"),
+    0,
+    TEXT("Draw the node connection graph (0 = off, 1 = on)."));
+
+static TAutoConsoleVariable<int32> CVarNodeDebugRelationMask(
+    TEXT("Node.Debug.RelationMask"),
+    -1,
+    TEXT("Bit mask of ENodeRelationType values to draw, -1 = all."));
+
+static TAutoConsoleVariable<float> CVarNodeDebugLODDistance(
+    TEXT("Node.Debug.LODDistance"),
+    3000.0f,
+    TEXT("Connections beyond this distance are drawn as thin lines."));
+
+static TAutoConsoleVariable<float> CVarNodeDebugMaxDistance(
+    TEXT("Node.Debug.MaxDistance"),
+    15000.0f,
+    TEXT("Connections beyond this distance are not drawn, 0 = unlimited."));
+
+static TAutoConsoleVariable<float> CVarNodeDebugThickness(
+    TEXT("Node.Debug.Thickness"),
+    5.0f,
+    TEXT("Line thickness of connections within the LOD distance."));
+
+static TAutoConsoleVariable<int32> CVarNodeDebugStateLabels(
+    TEXT("Node.Debug.StateLabels"),
+    0,
+    TEXT("Show state labels on the N nearest nodes within the LOD distance, 0 = off."));
+
+UNodeGraphDebugRenderer::UNodeGraphDebugRenderer()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+
+    LineBatch = nullptr;
+    BuiltGraphVersion = 0;
+    bGeometryDirty = true;
+    bHasSubmitted = false;
+}
+
+bool UNodeGraphDebugRenderer::IsEnabledByConsole()
+{
+    return CVarNodeDebugDrawGraph.GetValueOnGameThread() != 0;
+}
+
+bool UNodeGraphDebugRenderer::FViewState::Equals(const FViewState& Other) const
+{
+    // 视角微小抖动不触发重新提交
+    return Location.Equals(Other.Location, 10.0f)
+        && Rotation.Equals(Other.Rotation, 0.5f)
+        && FMath::IsNearlyEqual(FOV, Other.FOV, 0.1f)
+        && RelationMask == Other.RelationMask
+        && LODDistance == Other.LODDistance
+        && MaxDistance == Other.MaxDistance
+        && Thickness == Other.Thickness;
+}
+
+void UNodeGraphDebugRenderer::Update(const ANodeSystemManager& Manager)
+{
+    APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+    if (!CameraManager)
+    {
+        return;
+    }
+
+    const FMinimalViewInfo& ViewInfo = CameraManager->GetCameraCacheView();
+
+    FViewState View;
+    View.Location = ViewInfo.Location;
+    View.Rotation = ViewInfo.Rotation;
+    View.FOV = ViewInfo.FOV;
+    View.RelationMask = CVarNodeDebugRelationMask.GetValueOnGameThread();
+    View.LODDistance = CVarNodeDebugLODDistance.GetValueOnGameThread();
+    View.MaxDistance = CVarNodeDebugMaxDistance.GetValueOnGameThread();
+    View.Thickness = CVarNodeDebugThickness.GetValueOnGameThread();
+
+    const bool bRebuild = bGeometryDirty || BuiltGraphVersion != Manager.GraphVersion;
+    if (bRebuild)
+    {
+        RebuildEdges(Manager);
+    }
+
+    // 视锥只在需要提交或绘制标签时计算
+    const bool bSubmit = bRebuild || !bHasSubmitted || !View.Equals(SubmittedView);
+    const bool bDrawLabels = CVarNodeDebugStateLabels.GetValueOnGameThread() > 0;
+    if (!bSubmit && !bDrawLabels)
+    {
+        return;
+    }
+
+    FMatrix ViewMatrix, ProjectionMatrix, ViewProjectionMatrix;
+    UGameplayStatics::GetViewProjectionMatrix(ViewInfo, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+    FConvexVolume Frustum;
+    GetViewFrustumBounds(Frustum, ViewProjectionMatrix, false);
+
+    if (bSubmit)
+    {
+        SubmitLines(Frustum, View);
+    }
+
+    // 标签是一帧有效的调试字符串，需要每帧绘制
+    if (bDrawLabels)
+    {
+        DrawStateLabels(Manager, Frustum, View);
+    }
+}
+
+void UNodeGraphDebugRenderer::Clear()
+{
+    if (bHasSubmitted && LineBatch)
+    {
+        LineBatch->Flush();
+    }
+    bHasSubmitted = false;
+}
+
+void UNodeGraphDebugRenderer::RebuildEdges(const ANodeSystemManager& Manager)
+{
+    Edges.Reset(Manager.ActiveConnections.Num());
+    for (const ANodeConnection* Connection : Manager.ActiveConnections)
+    {
+        if (!Connection || !Connection->IsValid())
+        {
+            continue;
+        }
+
+        FDebugEdge& Edge = Edges.AddDefaulted_GetRef();
+        Edge.Start = Connection->GetSourceNode()->GetActorLocation();
+        Edge.End = Connection->GetTargetNode()->GetActorLocation();
+        Edge.Color = Connection->GetConnectionColor();
+        Edge.RelationType = Connection->RelationType;
+    }
+
+    BuiltGraphVersion = Manager.GraphVersion;
+    bGeometryDirty = false;
+}
+
+void UNodeGraphDebugRenderer::SubmitLines(const FConvexVolume& Frustum, const FViewState& View)
+{
+    ULineBatchComponent* Batch = GetOrCreateLineBatch();
+    if (!Batch)
+    {
+        return;
+    }
+
+    const uint32 RelationMask = static_cast<uint32>(View.RelationMask);
+    const float LODDistanceSq = FMath::Square(View.LODDistance);
+    const float MaxDistanceSq = View.MaxDistance > 0.0f ? FMath::Square(View.MaxDistance) : MAX_flt;
+
+    TArray<FBatchedLine> Lines;
+    Lines.Reserve(Edges.Num());
+    for (const FDebugEdge& Edge : Edges)
+    {
+        if ((RelationMask & (1u << static_cast<uint32>(Edge.RelationType))) == 0)
+        {
+            continue;
+        }
+
+        const float DistanceSq = FMath::PointDistToSegmentSquared(View.Location, Edge.Start, Edge.End);
+        if (DistanceSq > MaxDistanceSq)
+        {
+            continue;
+        }
+
+        const FBox Bounds(FVector::Min(Edge.Start, Edge.End), FVector::Max(Edge.Start, Edge.End));
+        if (!Frustum.IntersectBox(Bounds.GetCenter(), Bounds.GetExtent()))
+        {
+            continue;
+        }
+
+        // 远处画1像素细线
+        const float Thickness = DistanceSq <= LODDistanceSq ? View.Thickness : 0.0f;
+
+        // 生存时间为0：一直保留到下一次Flush
+        Lines.Emplace(Edge.Start, Edge.End, Edge.Color, 0.0f, Thickness, SDPG_World);
+    }
+
+    Batch->Flush();
+    Batch->DrawLines(Lines);
+
+    SubmittedView = View;
+    bHasSubmitted = true;
+}
+
+void UNodeGraphDebugRenderer::DrawStateLabels(const ANodeSystemManager& Manager, const FConvexVolume& Frustum, const FViewState& View) const
+{
+    // 经空间索引取LOD距离内最近的节点，数量受控制台变量限制
+    const int32 MaxLabels = CVarNodeDebugStateLabels.GetValueOnGameThread();
+    const TArray<AInteractiveNode*> Nodes = Manager.GetNearestNodes(View.Location, MaxLabels, View.LODDistance);
+
+    for (const AInteractiveNode* Node : Nodes)
+    {
+        const FVector Location = Node->GetActorLocation();
+        if (!Frustum.IntersectPoint(Location))
+        {
+            continue;
+        }
+
+        const FString Label = FString::Printf(TEXT("%s [%s]"),
+            *Node->GetNodeName(), *StaticEnum<ENodeState>()->GetNameStringByValue(static_cast<int64>(Node->GetNodeState())));
+        DrawDebugString(GetWorld(), Location + FVector(0.0f, 0.0f, 100.0f), Label, nullptr, FColor::White, 0.0f, false);
+    }
+}
+
+ULineBatchComponent* UNodeGraphDebugRenderer::GetOrCreateLineBatch()
+{
+    if (LineBatch || !GetOwner())
+    {
+        return LineBatch;
+    }
+
+    LineBatch = NewObject<ULineBatchComponent>(GetOwner());
+    LineBatch->SetUsingAbsoluteLocation(true);
+    LineBatch->SetUsingAbsoluteRotation(true);
+    LineBatch->SetUsingAbsoluteScale(true);
+    LineBatch->RegisterComponent();
+    return LineBatch;
+}
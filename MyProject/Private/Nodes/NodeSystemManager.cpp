@@ -5,10 +5,19 @@
 #include "Nodes/SceneNode.h"
 #include "Nodes/ItemNode.h"
 #include "Nodes/NodeConnection.h"
+#include "Nodes/NodeConnectionRenderer.h"
+#include "Nodes/NodeGraphDebugRenderer.h"
+#include "Nodes/NodeUIVisibilityService.h"
 #include "Nodes/Capabilities/ItemCapability.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "ConvexVolume.h"
+#include "SceneManagement.h"
+#include "Core/NodePathfinder.h"
 #include "MyProject/MyProjectCharacter.h"
 #include "Nodes/Capabilities/InteractiveCapability.h"
 #include "Nodes/Capabilities/NarrativeCapability.h"
@@ -22,11 +31,34 @@ ANodeSystemManager::ANodeSystemManager()
 {
     PrimaryActorTick.bCanEverTick = true;
 
+    // 连接的实例化渲染器
+    ConnectionRenderer = CreateDefaultSubobject<UNodeConnectionRenderer>(TEXT("ConnectionRenderer"));
+    RootComponent = ConnectionRenderer;
+
+    GraphDebugRenderer = CreateDefaultSubobject<UNodeGraphDebugRenderer>(TEXT("GraphDebugRenderer"));
+    UIVisibilityService = CreateDefaultSubobject<UNodeUIVisibilityService>(TEXT("UIVisibilityService"));
+
     // 默认配置
     NodeSpawnRadius = 500.0f;
     MaxNodesPerScene = 50;
     bAutoRegisterSpawnedNodes = true;
     bDebugDrawConnections = false;
+    CyclePolicy = ENodeCyclePolicy::Report;
+    PropagationBudgetMs = 2.0f;
+    MaxConnectionDestroysPerFrame = 64;
+    bIsDrainingStates = false;
+    ConditionEvaluationInterval = 0.1f;
+    NextConditionEvaluationTime = 0.0;
+    bIsApplyingGraphDelta = false;
+    SpatialCellSize = 500.0f;
+    bEnableSignificanceLOD = true;
+    SignificanceFullDistance = 2000.0f;
+    SignificanceReducedDistance = 5000.0f;
+    SignificanceMinimalDistance = 12000.0f;
+    SignificanceHysteresis = 0.1f;
+    SignificanceBoundsRadius = 200.0f;
+    SignificanceBudgetMs = 0.5f;
+    GraphVersion = 1;
     GenerationInterval = 0.1f;
 
     // 初始化状态
@@ -34,12 +66,17 @@ ANodeSystemManager::ANodeSystemManager()
     bIsTransitioning = false;
     TransitionProgress = 0.0f;
     TransitionTargetScene = nullptr;
+
+    // 每个ENodeState一个桶
+    StateBuckets.SetNum(StaticEnum<ENodeState>()->NumEnums() - 1);
 }
 
 void ANodeSystemManager::BeginPlay()
 {
     Super::BeginPlay();
 
+    NodeSpatialIndex.SetCellSize(SpatialCellSize);
+
     // 设置生成队列定时器
     GetWorld()->GetTimerManager().SetTimer(
         GenerationTimerHandle,
@@ -62,8 +99,19 @@ void ANodeSystemManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
     GetWorld()->GetTimerManager().ClearTimer(GenerationTimerHandle);
     GetWorld()->GetTimerManager().ClearTimer(ValidationTimerHandle);
 
-    // 清理所有节点和连接
+    // 清理所有节点和连接，关卡结束时不再分帧
     ResetSystem();
+    ProcessPendingConnectionDestroys(0);
+
+    // 仍在登记表中的能力不再由管理器检查
+    for (UStateCapability* Capability : StateCheckCapabilities)
+    {
+        if (Capability)
+        {
+            Capability->StateCheckIndex = INDEX_NONE;
+        }
+    }
+    StateCheckCapabilities.Empty();
 
     Super::EndPlay(EndPlayReason);
 }
@@ -79,26 +127,127 @@ void ANodeSystemManager::Tick(float DeltaTime)
         // 实际的过渡逻辑可以在这里实现
     }
 
-    // 调试绘制
-    if (bDebugDrawConnections)
+    // 按预算处理状态传播，未处理完的留到下一帧
+    if (!StatePropagator.IsEmpty())
     {
-        for (const auto& Connection : ActiveConnections)
-        {
-            if (Connection && Connection->IsValid())
-            {
-                FVector Start, End;
-                Start = Connection->GetSourceNode()->GetActorLocation();
-                End = Connection->GetTargetNode()->GetActorLocation();
-                
-                FColor Color = Connection->GetConnectionColor().ToFColor(true);
-                DrawDebugLine(GetWorld(), Start, End, Color, false, -1.0f, 0, 5.0f);
-            }
-        }
+        DrainStatePropagation(PropagationBudgetMs * 0.001);
+    }
+
+    // 能力条件按间隔批量检查，满足条件产生的状态请求进入传播工作表
+    if (GetWorld()->GetTimeSeconds() >= NextConditionEvaluationTime)
+    {
+        NextConditionEvaluationTime = GetWorld()->GetTimeSeconds() + ConditionEvaluationInterval;
+        EvaluateStateConditions();
+    }
+
+    // 端点移动过的连接每帧统一更新一次变换
+    if (DirtyConnectionTransforms.Num() > 0)
+    {
+        UpdateDirtyConnectionTransforms();
+    }
+
+    // 按预算评估节点显著性，层级变化的节点及其连接切换组件
+    if (bEnableSignificanceLOD)
+    {
+        UpdateSignificance(SignificanceBudgetMs * 0.001);
+    }
+
+    // 节点信息UI的显示/隐藏切换
+    UIVisibilityService->Update(*this);
+
+    // 分帧销毁已移除的连接
+    if (PendingConnectionDestroys.Num() > 0)
+    {
+        ProcessPendingConnectionDestroys(MaxConnectionDestroysPerFrame);
+    }
+
+    // 调试绘制：线段常驻，只在图、节点或视角变化后重新提交
+    if (bDebugDrawConnections || UNodeGraphDebugRenderer::IsEnabledByConsole())
+    {
+        GraphDebugRenderer->Update(*this);
+    }
+    else
+    {
+        GraphDebugRenderer->Clear();
     }
 }
 
 // 节点创建实现
 AInteractiveNode* ANodeSystemManager::CreateNode(TSubclassOf<AInteractiveNode> NodeClass, const FNodeGenerateData& GenerateData)
+{
+    AInteractiveNode* NewNode = SpawnNodeFromData(NodeClass, GenerateData);
+    if (NewNode)
+    {
+        // 自动注册
+        if (bAutoRegisterSpawnedNodes)
+        {
+            RegisterNode(NewNode);
+        }
+
+        // 处理能力
+        if (AItemNode* ItemNode = Cast<AItemNode>(NewNode))
+        {
+            ApplyGeneratedCapabilities(ItemNode, GenerateData.Capabilities);
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Created node %s"), *NewNode->GetNodeID());
+    }
+
+    return NewNode;
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::CreateNodes(const TArray<FNodeGenerateData>& GenerateDataList)
+{
+    TArray<AInteractiveNode*> CreatedNodes;
+    CreatedNodes.Reserve(GenerateDataList.Num());
+
+    // 与CreatedNodes一一对应的生成数据
+    TArray<const FNodeGenerateData*> CreatedData;
+    CreatedData.Reserve(GenerateDataList.Num());
+
+    // 自动注册时先按ID去重，避免生成注定注册失败的Actor
+    TSet<FString> BatchIDs;
+    if (bAutoRegisterSpawnedNodes)
+    {
+        BatchIDs.Reserve(GenerateDataList.Num());
+    }
+
+    int32 SkippedCount = 0;
+    for (const FNodeGenerateData& GenerateData : GenerateDataList)
+    {
+        if (bAutoRegisterSpawnedNodes && !IsNewNodeID(GenerateData.NodeData.NodeID, BatchIDs))
+        {
+            ++SkippedCount;
+            continue;
+        }
+
+        if (AInteractiveNode* NewNode = SpawnNodeFromData(GenerateData.NodeClass, GenerateData))
+        {
+            CreatedNodes.Add(NewNode);
+            CreatedData.Add(&GenerateData);
+        }
+    }
+
+    // 统一注册，索引一次性建好
+    if (bAutoRegisterSpawnedNodes)
+    {
+        RegisterNodes(CreatedNodes);
+    }
+
+    // 能力在注册之后添加，与CreateNode的顺序一致
+    for (int32 Index = 0; Index < CreatedNodes.Num(); ++Index)
+    {
+        if (AItemNode* ItemNode = Cast<AItemNode>(CreatedNodes[Index]))
+        {
+            ApplyGeneratedCapabilities(ItemNode, CreatedData[Index]->Capabilities);
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Created %d nodes (%d skipped)"), CreatedNodes.Num(), SkippedCount);
+    return CreatedNodes;
+}
+
+AInteractiveNode* ANodeSystemManager::SpawnNodeFromData(TSubclassOf<AInteractiveNode> NodeClass, const FNodeGenerateData& GenerateData)
 {
     if (!NodeClass)
     {
@@ -143,151 +292,142 @@ AInteractiveNode* ANodeSystemManager::CreateNode(TSubclassOf<AInteractiveNode> N
             NewNode->StoryContext.Add("EmotionType", UEnum::GetValueAsString(GenerateData.EmotionContext.PrimaryEmotion));
             NewNode->StoryContext.Add("EmotionIntensity", FString::SanitizeFloat(GenerateData.EmotionContext.Intensity));
         }
+    }
 
-        // 自动注册
-        if (bAutoRegisterSpawnedNodes)
+    return NewNode;
+}
+
+void ANodeSystemManager::ApplyGeneratedCapabilities(AItemNode* ItemNode, const TArray<FCapabilityData>& Capabilities)
+{
+    for (const FCapabilityData& CapData : Capabilities)
+    {
+        TSubclassOf<UItemCapability> CapClass;
+        if (CapData.CapabilityType != ECapabilityType::None)
         {
-            RegisterNode(NewNode);
+            switch (CapData.CapabilityType)
+            {
+                case ECapabilityType::Spatial:
+                    CapClass = USpatialCapability::StaticClass();
+                    break;
+                case ECapabilityType::State:
+                    CapClass = UStateCapability::StaticClass();
+                    break;
+                case ECapabilityType::Interactive:
+                    CapClass = UInteractiveCapability::StaticClass();
+                    break;
+                case ECapabilityType::Narrative:
+                    CapClass = UNarrativeCapability::StaticClass();
+                    break;
+                case ECapabilityType::Numerical:
+                    CapClass = UNumericalCapability::StaticClass();
+                    break;
+                case ECapabilityType::System:
+                    CapClass = USystemCapability::StaticClass();
+                    break;
+                case ECapabilityType::None:
+                    break;
+            }
         }
-
-        // 处理能力
-        if (AItemNode* ItemNode = Cast<AItemNode>(NewNode))
+        if (CapClass)
         {
-            for (const FCapabilityData& CapData : GenerateData.Capabilities)
+            UItemCapability* Capability = ItemNode->AddCapability(CapClass);
+            if (Capability)
             {
-                TSubclassOf<UItemCapability> CapClass;
-                if (CapData.CapabilityType != ECapabilityType::None)
+                // 设置能力ID（如果提供）
+                if (!CapData.CapabilityID.IsEmpty())
                 {
-                    switch (CapData.CapabilityType)
-                    {
-                        case ECapabilityType::Spatial:
-                            CapClass = USpatialCapability::StaticClass();
-                            break;
-                        case ECapabilityType::State:
-                            CapClass = UStateCapability::StaticClass();
-                            break;
-                        case ECapabilityType::Interactive:
-                            CapClass = UInteractiveCapability::StaticClass();
-                            break;
-                        case ECapabilityType::Narrative:
-                            CapClass = UNarrativeCapability::StaticClass();
-                            break;
-                        case ECapabilityType::Numerical:
-                            CapClass = UNumericalCapability::StaticClass();
-                            break;
-                        case ECapabilityType::System:
-                            CapClass = USystemCapability::StaticClass();
-                            break;
-                        case ECapabilityType::None:
-                            break;
-                    }
+                    Capability->CapabilityID = CapData.CapabilityID;
                 }
-                if (CapClass)
+
+                // 根据能力类型应用特定配置
+                switch (CapData.CapabilityType)
                 {
-                    UItemCapability* Capability = ItemNode->AddCapability(CapClass);
-                    if (Capability)
+                    case ECapabilityType::Spatial:
+                    {
+                        USpatialCapability* SpatialCap = Cast<USpatialCapability>(Capability);
+                        if (SpatialCap)
+                        {
+                            // 应用空间能力配置
+                            SpatialCap->bCanContainNodes = CapData.SpatialConfig.bCanContainNodes;
+                            SpatialCap->MaxContainedNodes = CapData.SpatialConfig.MaxContainedNodes;
+                        }
+                        break;
+                    }
+                    case ECapabilityType::State:
+                    {
+                        UStateCapability* StateCap = Cast<UStateCapability>(Capability);
+                        if (StateCap)
+                        {
+                            // 应用状态能力配置
+                            StateCap->PossibleStates = CapData.StateConfig.PossibleStates;
+                            StateCap->StateChangeRadius = CapData.StateConfig.StateChangeRadius;
+                        }
+                        break;
+                    }
+                    case ECapabilityType::Interactive:
+                    {
+                        UInteractiveCapability* InteractiveCap = Cast<UInteractiveCapability>(Capability);
+                        if (InteractiveCap)
+                        {
+                            // 应用交互能力配置
+                            InteractiveCap->AllowedInteractions = CapData.InteractiveConfig.AllowedInteractions;
+                            InteractiveCap->ObservableInfo = CapData.InteractiveConfig.ObservableInfo;
+                            InteractiveCap->DialogueOptions = CapData.InteractiveConfig.DialogueOptions;
+                            InteractiveCap->MaxAttempts = CapData.InteractiveConfig.MaxAttempts;
+                        }
+                        break;
+                    }
+                    case ECapabilityType::Narrative:
                     {
-                        // 设置能力ID（如果提供）
-                        if (!CapData.CapabilityID.IsEmpty())
+                        UNarrativeCapability* NarrativeCap = Cast<UNarrativeCapability>(Capability);
+                        if (NarrativeCap)
                         {
-                            Capability->CapabilityID = CapData.CapabilityID;
+                            // 应用叙事能力配置
+                            NarrativeCap->StoryProgressionPath = CapData.NarrativeConfig.StoryProgressionPath;
                         }
-                        
-                        // 根据能力类型应用特定配置
-                        switch (CapData.CapabilityType)
+                        break;
+                    }
+                    case ECapabilityType::System:
+                    {
+                        USystemCapability* SystemCap = Cast<USystemCapability>(Capability);
+                        if (SystemCap)
                         {
-                            case ECapabilityType::Spatial:
-                            {
-                                USpatialCapability* SpatialCap = Cast<USpatialCapability>(Capability);
-                                if (SpatialCap)
-                                {
-                                    // 应用空间能力配置
-                                    SpatialCap->bCanContainNodes = CapData.SpatialConfig.bCanContainNodes;
-                                    SpatialCap->MaxContainedNodes = CapData.SpatialConfig.MaxContainedNodes;
-                                }
-                                break;
-                            }
-                            case ECapabilityType::State:
-                            {
-                                UStateCapability* StateCap = Cast<UStateCapability>(Capability);
-                                if (StateCap)
-                                {
-                                    // 应用状态能力配置
-                                    StateCap->PossibleStates = CapData.StateConfig.PossibleStates;
-                                    StateCap->StateChangeRadius = CapData.StateConfig.StateChangeRadius;
-                                }
-                                break;
-                            }
-                            case ECapabilityType::Interactive:
-                            {
-                                UInteractiveCapability* InteractiveCap = Cast<UInteractiveCapability>(Capability);
-                                if (InteractiveCap)
-                                {
-                                    // 应用交互能力配置
-                                    InteractiveCap->AllowedInteractions = CapData.InteractiveConfig.AllowedInteractions;
-                                    InteractiveCap->ObservableInfo = CapData.InteractiveConfig.ObservableInfo;
-                                    InteractiveCap->DialogueOptions = CapData.InteractiveConfig.DialogueOptions;
-                                    InteractiveCap->MaxAttempts = CapData.InteractiveConfig.MaxAttempts;
-                                }
-                                break;
-                            }
-                            case ECapabilityType::Narrative:
-                            {
-                                UNarrativeCapability* NarrativeCap = Cast<UNarrativeCapability>(Capability);
-                                if (NarrativeCap)
-                                {
-                                    // 应用叙事能力配置
-                                    NarrativeCap->StoryProgressionPath = CapData.NarrativeConfig.StoryProgressionPath;
-                                }
-                                break;
-                            }
-                            case ECapabilityType::System:
-                            {
-                                USystemCapability* SystemCap = Cast<USystemCapability>(Capability);
-                                if (SystemCap)
-                                {
-                                    // 应用系统能力配置
-                                    SystemCap->TimeScale = CapData.SystemConfig.TimeScale;
-                                    SystemCap->ConditionRules = CapData.SystemConfig.ConditionRules;
-                                }
-                                break;
-                            }
-                            case ECapabilityType::Numerical:
-                            {
-                                UNumericalCapability* NumericalCap = Cast<UNumericalCapability>(Capability);
-                                if (NumericalCap)
-                                {
-                                    // 应用数值能力配置
-                                }
-                                break;
-                            }
-                            case ECapabilityType::None:
-                                // 无特定类型，不应用特定配置
-                                break;
+                            // 应用系统能力配置
+                            SystemCap->TimeScale = CapData.SystemConfig.TimeScale;
+                            SystemCap->ConditionRules = CapData.SystemConfig.ConditionRules;
                         }
-                        
-                        // 应用通用参数
-                        // for (const auto& Param : CapData.CapabilityParameters)
-                        // {
-                        //     // 这里可以处理通用参数
-                        //     UE_LOG(LogTemp, Log, TEXT("Setting capability parameter %s = %s for %s"), 
-                        //         *Param.Key, *Param.Value, *Capability->GetCapabilityID());
-                        // }
-                        
-                        // 如果需要自动激活，则激活能力
-                        if (CapData.bAutoActivate)
+                        break;
+                    }
+                    case ECapabilityType::Numerical:
+                    {
+                        UNumericalCapability* NumericalCap = Cast<UNumericalCapability>(Capability);
+                        if (NumericalCap)
                         {
-                            Capability->Activate();
+                            // 应用数值能力配置
                         }
+                        break;
                     }
+                    case ECapabilityType::None:
+                        // 无特定类型，不应用特定配置
+                        break;
+                }
+
+                // 应用通用参数
+                // for (const auto& Param : CapData.CapabilityParameters)
+                // {
+                //     // 这里可以处理通用参数
+                //     UE_LOG(LogTemp, Log, TEXT("Setting capability parameter %s = %s for %s"), 
+                //         *Param.Key, *Param.Value, *Capability->GetCapabilityID());
+                // }
+
+                // 如果需要自动激活，则激活能力
+                if (CapData.bAutoActivate)
+                {
+                    Capability->Activate();
                 }
             }
         }
-
-        UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Created node %s"), *NewNode->GetNodeID());
     }
-
-    return NewNode;
 }
 
 ASceneNode* ANodeSystemManager::CreateSceneNode(const FNodeGenerateData& GenerateData)
@@ -330,7 +470,7 @@ bool ANodeSystemManager::RegisterNode(AInteractiveNode* Node)
         return false;
     }
 
-    FString NodeID = Node->GetNodeID();
+    const FString& NodeID = Node->GetNodeIDRef();
     if (NodeID.IsEmpty())
     {
         UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot register node without ID"));
@@ -338,33 +478,103 @@ bool ANodeSystemManager::RegisterNode(AInteractiveNode* Node)
     }
 
     // 检查是否已注册
-    if (NodeRegistry.Contains(NodeID))
+    if (NodeIDTable.Contains(NodeID))
     {
         UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Node %s already registered"), *NodeID);
         return false;
     }
 
-    // 添加到注册表
-    NodeRegistry.Add(NodeID, Node);
+    AddNodeToRegistry(Node, NodeID);
+
+    // 广播事件
+    OnNodeRegistered.Broadcast(Node);
+
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Registered node %s"), *NodeID);
+    return true;
+}
+
+int32 ANodeSystemManager::RegisterNodes(const TArray<AInteractiveNode*>& Nodes)
+{
+    // 预先扩容，避免逐个注册时反复增长
+    NodeSlots.Reserve(NodeSlots.Num() + FMath::Max(Nodes.Num() - FreeNodeSlots.Num(), 0));
+    NodeIDTable.Reserve(NodeIDTable.Num() + Nodes.Num());
+    NodeTagIndex.ReserveSlots(NodeSlots.Max());
+    NodeSpatialIndex.ReserveSlots(NodeSlots.Max());
+
+    TSet<FString> BatchIDs;
+    BatchIDs.Reserve(Nodes.Num());
+
+    TArray<AInteractiveNode*> RegisteredNodes;
+    RegisteredNodes.Reserve(Nodes.Num());
+
+    for (AInteractiveNode* Node : Nodes)
+    {
+        if (!Node || !IsNewNodeID(Node->GetNodeIDRef(), BatchIDs))
+        {
+            continue;
+        }
+
+        AddNodeToRegistry(Node, Node->GetNodeIDRef());
+        RegisteredNodes.Add(Node);
+    }
+
+    if (RegisteredNodes.Num() > 0)
+    {
+        OnNodesRegistered.Broadcast(RegisteredNodes);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Registered %d of %d nodes"), RegisteredNodes.Num(), Nodes.Num());
+    return RegisteredNodes.Num();
+}
+
+bool ANodeSystemManager::IsNewNodeID(const FString& NodeID, TSet<FString>& BatchIDs) const
+{
+    if (NodeID.IsEmpty() || NodeIDTable.Contains(NodeID))
+    {
+        return false;
+    }
+
+    bool bAlreadyInBatch = false;
+    BatchIDs.Add(NodeID, &bAlreadyInBatch);
+    return !bAlreadyInBatch;
+}
+
+void ANodeSystemManager::AddNodeToRegistry(AInteractiveNode* Node, const FString& NodeID)
+{
+    // 分配槽位并驻留ID
+    FNodeHandle Handle = AllocateNodeSlot(Node, NodeID);
+    NodeIDTable.Add(NodeID, Handle);
+    Node->NodeHandle = Handle;
 
     // 更新索引
     UpdateNodeTypeMap(Node, true);
     UpdateNodeTagMap(Node, true);
 
-    // 添加到活动列表
-    if (Node->GetNodeState() == ENodeState::Active)
+    // 放入当前状态的桶
+    AddToStateBucket(Node);
+
+    // 加入空间索引
+    NodeSpatialIndex.Insert(Handle.Index, Node->GetActorLocation());
+    NodeComponents.AddSlot(Handle.Index);
+
+    // 挂到所属场景下；场景本身注册时收养已注册的子节点
+    UpdateNodeHierarchy(Node);
+    if (const ASceneNode* SceneNode = Cast<ASceneNode>(Node))
     {
-        ActiveNodes.AddUnique(Node);
+        for (AInteractiveNode* Child : SceneNode->GetChildNodesView())
+        {
+            const FNodeHandle ChildHandle = GetRegisteredHandle(Child);
+            if (ChildHandle.IsValid() && Child->GetOwningScene() == SceneNode)
+            {
+                NodeHierarchy.SetSceneParent(ChildHandle.Index, Handle.Index);
+            }
+        }
     }
 
     // 注册事件
     RegisterNodeEvents(Node);
 
-    // 广播事件
-    OnNodeRegistered.Broadcast(Node);
-
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Registered node %s"), *NodeID);
-    return true;
+    MarkGraphDirty();
 }
 
 bool ANodeSystemManager::UnregisterNodeByID(const FString& NodeID)
@@ -380,757 +590,1890 @@ bool ANodeSystemManager::UnregisterNode(AInteractiveNode* Node)
         return false;
     }
 
-    FString NodeID = Node->GetNodeID();
-
-    // 从注册表移除
-    if (!NodeRegistry.Remove(NodeID))
+    FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (!Handle.IsValid())
     {
         return false;
     }
 
+    // 使用注册时驻留的ID，节点数据可能在注册后被修改
+    FString NodeID = NodeSlots[Handle.Index].NodeID;
+
     // 更新索引
     UpdateNodeTypeMap(Node, false);
     UpdateNodeTagMap(Node, false);
 
-    // 从活动列表移除
-    ActiveNodes.Remove(Node);
+    // 从状态桶移除
+    RemoveFromStateBucket(Node);
+
+    // 移除所有相关连接（槽位释放前进行）
+    RemoveAllConnectionsForHandle(Handle);
+
+    // 脱离层级：先解除以该场景为父的子节点，再移除自身
+    if (const ASceneNode* SceneNode = Cast<ASceneNode>(Node))
+    {
+        for (AInteractiveNode* Child : SceneNode->GetChildNodesView())
+        {
+            const FNodeHandle ChildHandle = GetRegisteredHandle(Child);
+            if (ChildHandle.IsValid())
+            {
+                NodeHierarchy.SetSceneParent(ChildHandle.Index, INDEX_NONE);
+            }
+        }
+    }
+    NodeHierarchy.RemoveNode(Handle.Index);
+    StatePropagator.RemoveSlot(Handle.Index);
+    NodeComponents.MarkStale();
+
+    NodeSpatialIndex.Remove(Handle.Index);
 
-    // 移除所有相关连接
-    RemoveAllConnectionsForNode(NodeID);
+    // 离开系统的节点恢复全部组件
+    NodeSignificance.RemoveSlot(Handle.Index);
+    Node->ApplySignificanceTier(ENodeSignificanceTier::Full);
+
+    // 从注册表移除
+    NodeIDTable.Remove(NodeID);
+    ReleaseNodeSlot(Handle);
+    Node->NodeHandle.Invalidate();
+    MarkGraphDirty();
 
     // 注销事件
     UnregisterNodeEvents(Node);
 
     // 广播事件
-    OnNodeUnregistered.Broadcast(Node);
+    if (!bIsApplyingGraphDelta)
+    {
+        OnNodeUnregistered.Broadcast(Node);
+    }
 
     UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Unregistered node %s"), *NodeID);
     return true;
 }
 
-// 节点查询实现
-AInteractiveNode* ANodeSystemManager::GetNode(const FString& NodeID) const
+// 图增量实现
+FNodeGraphDeltaResult ANodeSystemManager::ApplyGraphDelta(const FNodeGraphDelta& Delta)
 {
-    if (NodeRegistry.Contains(NodeID))
-    {
-        return NodeRegistry[NodeID];
-    }
-    return nullptr;
-}
+    FNodeGraphDeltaResult Result;
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByType(ENodeType Type) const
-{
-    FString TypeKey = UEnum::GetValueAsString(Type);
-    if (NodeTypeMap.Contains(TypeKey))
+    Result.ErrorMessage = ValidateGraphDelta(Delta);
+    if (!Result.ErrorMessage.IsEmpty())
     {
-        return NodeTypeMap[TypeKey];
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Rejected graph delta: %s"), *Result.ErrorMessage);
+        return Result;
     }
-    return TArray<AInteractiveNode*>();
-}
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByState(ENodeState State) const
-{
-    TArray<AInteractiveNode*> Result;
-    
-    for (const auto& Pair : NodeRegistry)
+    TArray<ANodeConnection*> RemovedConnections;
+    TArray<AInteractiveNode*> NodesToRemove;
     {
-        if (Pair.Value && Pair.Value->GetNodeState() == State)
+        TGuardValue<bool> DeltaGuard(bIsApplyingGraphDelta, true);
+
+        // 生成新增节点，全部成功后统一注册
+        Result.CreatedNodes.Reserve(Delta.AddedNodes.Num());
+        for (const FNodeGenerateData& GenerateData : Delta.AddedNodes)
         {
-            Result.Add(Pair.Value);
+            AInteractiveNode* NewNode = SpawnNodeFromData(ResolveGeneratedNodeClass(GenerateData), GenerateData);
+            if (!NewNode)
+            {
+                Result.ErrorMessage = FString::Printf(TEXT("Failed to spawn node %s"), *GenerateData.NodeData.NodeID);
+                RollbackGraphDelta(Result.CreatedConnections, Result.CreatedNodes);
+                Result.CreatedNodes.Reset();
+                UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Rolled back graph delta: %s"), *Result.ErrorMessage);
+                return Result;
+            }
+            Result.CreatedNodes.Add(NewNode);
         }
-    }
-    
-    return Result;
-}
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByTag(const FGameplayTag& Tag) const
-{
-    TArray<AInteractiveNode*> Result;
-    FString TagString = Tag.ToString();
-    
-    if (NodeTagMap.Contains(TagString))
-    {
-        Result = NodeTagMap[TagString];
-    }
-    
-    return Result;
-}
+        NodeSlots.Reserve(NodeSlots.Num() + FMath::Max(Result.CreatedNodes.Num() - FreeNodeSlots.Num(), 0));
+        NodeIDTable.Reserve(NodeIDTable.Num() + Result.CreatedNodes.Num());
+        NodeTagIndex.ReserveSlots(NodeSlots.Max());
+        NodeSpatialIndex.ReserveSlots(NodeSlots.Max());
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetNodesInRadius(const FVector& Center, float Radius) const
-{
-    TArray<AInteractiveNode*> Result;
-    float RadiusSq = Radius * Radius;
-    
-    for (const auto& Pair : NodeRegistry)
-    {
-        if (Pair.Value)
+        for (AInteractiveNode* Node : Result.CreatedNodes)
         {
-            float DistSq = FVector::DistSquared(Pair.Value->GetActorLocation(), Center);
-            if (DistSq <= RadiusSq)
-            {
-                Result.Add(Pair.Value);
-            }
+            AddNodeToRegistry(Node, Node->GetNodeIDRef());
         }
-    }
-    
-    return Result;
-}
 
-TArray<AItemNode*> ANodeSystemManager::FindNodesWithCapability(TSubclassOf<UItemCapability> CapabilityClass) const
-{
-    TArray<AItemNode*> Result;
-    
-    if (!CapabilityClass)
-    {
-        return Result;
-    }
-    
-    for (const auto& Pair : NodeRegistry)
-    {
-        if (AItemNode* ItemNode = Cast<AItemNode>(Pair.Value))
+        for (int32 Index = 0; Index < Result.CreatedNodes.Num(); ++Index)
         {
-            if (ItemNode->HasCapability(CapabilityClass))
+            if (AItemNode* ItemNode = Cast<AItemNode>(Result.CreatedNodes[Index]))
             {
-                Result.Add(ItemNode);
+                ApplyGeneratedCapabilities(ItemNode, Delta.AddedNodes[Index].Capabilities);
             }
         }
-    }
-    
-    return Result;
-}
-
-void ANodeSystemManager::OnPlayerNodeInteractionEvent(AItemNode* Node, EInteractionType Type, bool bIsStarting)
-{
-    if (bIsStarting)
-    {
-        OnInteractionStarted(Node, Type);
-    }
-    else
-    {
-        OnInteractionEnded(Node, Type);
-    }
-}
 
-void ANodeSystemManager::BindPlayerInteractionEvents()
-{
-    if (APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0))
-    {
-        if (AMyProjectCharacter* Player = ((AMyProjectCharacter*)Cast<AMyProjectCharacter>(PC->GetPawn())))
+        // 新增关系，端点已全部注册
+        Result.CreatedConnections.Reserve(Delta.AddedRelations.Num());
+        for (const FNodeRelationData& Relation : Delta.AddedRelations)
         {
-            if (UPlayerInteractionManager* InteractionManager = Player->GetInteractionManager())
+            ANodeConnection* NewConnection = CreateConnection(GetNode(Relation.SourceNodeID), GetNode(Relation.TargetNodeID), Relation);
+            if (!NewConnection)
             {
-                // 绑定委托
-                InteractionManager->OnNodeInteraction.AddDynamic(this, &ANodeSystemManager::OnPlayerNodeInteractionEvent);
+                Result.ErrorMessage = FString::Printf(TEXT("Failed to create %s relation %s -> %s"),
+                    *UEnum::GetValueAsString(Relation.RelationType), *Relation.SourceNodeID, *Relation.TargetNodeID);
+                RollbackGraphDelta(Result.CreatedConnections, Result.CreatedNodes);
+                Result.CreatedNodes.Reset();
+                Result.CreatedConnections.Reset();
+                UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Rolled back graph delta: %s"), *Result.ErrorMessage);
+                return Result;
+            }
+            Result.CreatedConnections.Add(NewConnection);
+        }
+
+        // 新增部分已提交，以下步骤均已校验，不会失败
+        // 移除的关系和被移除节点的全部连接合成一次批量移除
+        TSet<ANodeConnection*> ConnectionSet;
+        for (const FNodeRelationData& Relation : Delta.RemovedRelations)
+        {
+            const FNodeEdgeKey Key(FindNodeHandle(Relation.SourceNodeID), FindNodeHandle(Relation.TargetNodeID), Relation.RelationType);
+            if (ANodeConnection* Connection = ConnectionEdgeIndex.FindRef(Key))
+            {
+                ConnectionSet.Add(Connection);
+            }
+        }
+
+        NodesToRemove.Reserve(Delta.RemovedNodeIDs.Num());
+        for (const FString& NodeID : Delta.RemovedNodeIDs)
+        {
+            if (const FNodeSlot* Slot = FindNodeSlot(FindNodeHandle(NodeID)))
+            {
+                NodesToRemove.Add(Slot->Node);
+                ConnectionSet.Append(Slot->Connections);
+            }
+        }
+
+        RemovedConnections = ConnectionSet.Array();
+        Result.RemovedConnectionCount = RemoveConnections(RemovedConnections);
+
+        // 连接已清空，注销时不会再逐节点移除连接；销毁留到批量事件广播之后
+        for (AInteractiveNode* Node : NodesToRemove)
+        {
+            Result.RemovedNodeIDs.Add(NodeSlots[Node->GetNodeHandle().Index].NodeID);
+            UnregisterNode(Node);
+        }
+
+        for (const FNodePropertyDelta& PropertyDelta : Delta.PropertyChanges)
+        {
+            if (AInteractiveNode* Node = GetNode(PropertyDelta.NodeID))
+            {
+                ApplyNodePropertyDelta(Node, PropertyDelta);
+                Result.ModifiedNodeCount++;
             }
         }
     }
-}
 
-void ANodeSystemManager::OnInteractionStarted(AItemNode* Node, EInteractionType Type)
-{
-    // 根据类型分发
-    switch(Type)
+    // 解锁层级在状态请求入队前更新
+    if (Delta.AddedRelations.Num() > 0 || RemovedConnections.Num() > 0)
     {
-        case EInteractionType::Click:
-        case EInteractionType::Hold:
-            OnNodeSelected(Node);
-            break;
-        case EInteractionType::Hover:
-            OnNodeHoverStarted(Node);
-            break;
-        case EInteractionType::Drag:
-            OnNodeDragStarted(Node);
-            break;
-        default:
-            // 其他类型的交互
-            UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Unknown interaction type"));
-            break;
+        AnalyzeRelationGraph();
     }
-}
 
-void ANodeSystemManager::OnInteractionEnded(AItemNode* Node, EInteractionType Type)
-{
-    // 根据类型分发
-    switch(Type)
+    for (const FNodeStateDelta& StateDelta : Delta.StateChanges)
     {
-    case EInteractionType::Click:
-    case EInteractionType::Hold:
-        OnNodeDeselected(Node);
-        break;
-    case EInteractionType::Hover:
-        OnNodeHoverEnded(Node);
-        break;
-    case EInteractionType::Drag:
-        OnNodeDragEnded(Node);
-        break;
-    default:
-        // 其他类型的交互
-        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Unknown interaction type"));
-        break;
+        if (RequestNodeState(GetNode(StateDelta.NodeID), StateDelta.NewState))
+        {
+            Result.QueuedStateChangeCount++;
+        }
     }
-}
-
-void ANodeSystemManager::OnNodeSelected(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Selected"), *Node->GetNodeName());
-}
-
-void ANodeSystemManager::OnNodeDeselected(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Deselected"), *Node->GetNodeName());
-}
 
-void ANodeSystemManager::OnNodeDragStarted(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Drag"), *Node->GetNodeName());
-}
+    Result.bSuccess = true;
 
-void ANodeSystemManager::OnNodeDragEnded(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s DragEnd"), *Node->GetNodeName());
-}
+    // 逐项事件合并为每类一次批量广播
+    if (Result.CreatedNodes.Num() > 0)
+    {
+        OnNodesRegistered.Broadcast(Result.CreatedNodes);
+    }
+    if (Result.CreatedConnections.Num() > 0)
+    {
+        OnConnectionsCreated.Broadcast(Result.CreatedConnections);
+    }
+    if (RemovedConnections.Num() > 0)
+    {
+        OnConnectionsRemoved.Broadcast(RemovedConnections);
+    }
+    if (NodesToRemove.Num() > 0)
+    {
+        OnNodesUnregistered.Broadcast(NodesToRemove);
+    }
+    OnGraphDeltaApplied.Broadcast(Result);
 
-void ANodeSystemManager::OnNodeHoverStarted(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Hover"), *Node->GetNodeName());
-}
+    for (AInteractiveNode* Node : NodesToRemove)
+    {
+        Node->Destroy();
+    }
 
-void ANodeSystemManager::OnNodeHoverEnded(AItemNode* Node)
-{
-    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s HoverEnd"), *Node->GetNodeName());
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Applied graph delta (%d operations): +%d nodes, -%d nodes, +%d connections, -%d connections"),
+        Delta.GetOperationCount(), Result.CreatedNodes.Num(), Result.RemovedNodeIDs.Num(),
+        Result.CreatedConnections.Num(), Result.RemovedConnectionCount);
+    return Result;
 }
 
-// 连接管理实现
-ANodeConnection* ANodeSystemManager::CreateConnection(AInteractiveNode* Source, AInteractiveNode* Target, const FNodeRelationData& RelationData)
+FString ANodeSystemManager::ValidateGraphDelta(const FNodeGraphDelta& Delta) const
 {
-    if (!Source || !Target)
+    // 新增节点：ID未注册、批内不重复、能解析出类
+    TSet<FString> AddedIDs;
+    AddedIDs.Reserve(Delta.AddedNodes.Num());
+    for (const FNodeGenerateData& GenerateData : Delta.AddedNodes)
     {
-        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot create connection without valid nodes"));
-        return nullptr;
+        const FString& NodeID = GenerateData.NodeData.NodeID;
+        if (!IsNewNodeID(NodeID, AddedIDs))
+        {
+            return FString::Printf(TEXT("Added node ID '%s' is empty, already registered or duplicated"), *NodeID);
+        }
+        if (!ResolveGeneratedNodeClass(GenerateData))
+        {
+            return FString::Printf(TEXT("No node class for added node %s"), *NodeID);
+        }
     }
 
-    if (Source == Target)
+    // 移除节点：必须已注册
+    TSet<FString> RemovedIDs;
+    RemovedIDs.Reserve(Delta.RemovedNodeIDs.Num());
+    for (const FString& NodeID : Delta.RemovedNodeIDs)
     {
-        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot create self-connection"));
-        return nullptr;
+        bool bAlreadyInSet = false;
+        RemovedIDs.Add(NodeID, &bAlreadyInSet);
+        if (bAlreadyInSet || !NodeIDTable.Contains(NodeID))
+        {
+            return FString::Printf(TEXT("Removed node %s is not registered or duplicated"), *NodeID);
+        }
     }
 
-    // 检查是否已存在连接
-    ANodeConnection* ExistingConnection = GetConnection(Source->GetNodeID(), Target->GetNodeID());
-    if (ExistingConnection)
+    // 应用后仍然存在的节点
+    auto IsLiveAfterDelta = [this, &AddedIDs, &RemovedIDs](const FString& NodeID)
     {
-        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Connection already exists between %s and %s"), 
-            *Source->GetNodeID(), *Target->GetNodeID());
-        return ExistingConnection;
-    }
+        return AddedIDs.Contains(NodeID) || (NodeIDTable.Contains(NodeID) && !RemovedIDs.Contains(NodeID));
+    };
 
-    // 创建连接
-    UWorld* World = GetWorld();
-    if (!World)
-    {
-        return nullptr;
-    }
+    using FRelationKey = TTuple<FString, FString, uint8>;
 
-    TSubclassOf<ANodeConnection> ConnectionClass = DefaultConnectionClass;
-    if (!ConnectionClass)
+    // 移除关系：连接必须存在
+    TSet<FRelationKey> RemovedRelationKeys;
+    RemovedRelationKeys.Reserve(Delta.RemovedRelations.Num());
+    for (const FNodeRelationData& Relation : Delta.RemovedRelations)
     {
-        ConnectionClass = ANodeConnection::StaticClass();
+        const FNodeEdgeKey Key(FindNodeHandle(Relation.SourceNodeID), FindNodeHandle(Relation.TargetNodeID), Relation.RelationType);
+        bool bAlreadyInSet = false;
+        RemovedRelationKeys.Add(FRelationKey(Relation.SourceNodeID, Relation.TargetNodeID, static_cast<uint8>(Relation.RelationType)), &bAlreadyInSet);
+        if (bAlreadyInSet || !ConnectionEdgeIndex.Contains(Key))
+        {
+            return FString::Printf(TEXT("Removed %s relation %s -> %s does not exist or is duplicated"),
+                *UEnum::GetValueAsString(Relation.RelationType), *Relation.SourceNodeID, *Relation.TargetNodeID);
+        }
     }
 
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-    ANodeConnection* NewConnection = World->SpawnActor<ANodeConnection>(ConnectionClass, SpawnParams);
-    if (NewConnection)
+    // 新增关系：端点在应用后存在，且不与现有连接或批内其他关系重复
+    // 新增先于移除执行，同一增量中不能先移除再重建同一关系
+    TSet<FRelationKey> AddedRelationKeys;
+    AddedRelationKeys.Reserve(Delta.AddedRelations.Num());
+    for (const FNodeRelationData& Relation : Delta.AddedRelations)
     {
-        // 初始化连接
-        NewConnection->Initialize(Source, Target, RelationData.RelationType);
-        NewConnection->SetConnectionWeight(RelationData.Weight);
-        NewConnection->SetBidirectional(RelationData.bBidirectional);
-
-        // 添加到注册表
-        if (!ConnectionRegistry.Contains(Source->GetNodeID()))
+        if (Relation.SourceNodeID == Relation.TargetNodeID)
         {
-            ConnectionRegistry.Add(Source->GetNodeID(), TArray<ANodeConnection*>());
+            return FString::Printf(TEXT("Added relation on %s is a self-connection"), *Relation.SourceNodeID);
         }
-        ConnectionRegistry[Source->GetNodeID()].Add(NewConnection);
-
-        if (RelationData.bBidirectional || Target->GetNodeID() != Source->GetNodeID())
+        if (!IsLiveAfterDelta(Relation.SourceNodeID) || !IsLiveAfterDelta(Relation.TargetNodeID))
         {
-            if (!ConnectionRegistry.Contains(Target->GetNodeID()))
-            {
-                ConnectionRegistry.Add(Target->GetNodeID(), TArray<ANodeConnection*>());
-            }
-            ConnectionRegistry[Target->GetNodeID()].Add(NewConnection);
+            return FString::Printf(TEXT("Added relation %s -> %s references a missing or removed node"),
+                *Relation.SourceNodeID, *Relation.TargetNodeID);
         }
 
-        // 添加到活动连接
-        ActiveConnections.Add(NewConnection);
-
-        // 注册事件
-        RegisterConnectionEvents(NewConnection);
+        const FNodeEdgeKey Key(FindNodeHandle(Relation.SourceNodeID), FindNodeHandle(Relation.TargetNodeID), Relation.RelationType);
+        bool bAlreadyInSet = false;
+        AddedRelationKeys.Add(FRelationKey(Relation.SourceNodeID, Relation.TargetNodeID, static_cast<uint8>(Relation.RelationType)), &bAlreadyInSet);
+        if (bAlreadyInSet || (Key.Source.IsValid() && Key.Target.IsValid() && ConnectionEdgeIndex.Contains(Key)))
+        {
+            return FString::Printf(TEXT("Added %s relation %s -> %s already exists or is duplicated"),
+                *UEnum::GetValueAsString(Relation.RelationType), *Relation.SourceNodeID, *Relation.TargetNodeID);
+        }
+    }
 
-        // 广播事件
-        OnConnectionCreated.Broadcast(NewConnection);
+    for (const FNodePropertyDelta& PropertyDelta : Delta.PropertyChanges)
+    {
+        if (!IsLiveAfterDelta(PropertyDelta.NodeID))
+        {
+            return FString::Printf(TEXT("Property change targets missing or removed node %s"), *PropertyDelta.NodeID);
+        }
+    }
 
-        UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Created connection between %s and %s"), 
-            *Source->GetNodeID(), *Target->GetNodeID());
+    for (const FNodeStateDelta& StateDelta : Delta.StateChanges)
+    {
+        if (!IsLiveAfterDelta(StateDelta.NodeID))
+        {
+            return FString::Printf(TEXT("State change targets missing or removed node %s"), *StateDelta.NodeID);
+        }
     }
 
-    return NewConnection;
+    return FString();
 }
 
-ANodeConnection* ANodeSystemManager::CreateConnectionBetween(const FString& SourceID, const FString& TargetID, ENodeRelationType Type)
+TSubclassOf<AInteractiveNode> ANodeSystemManager::ResolveGeneratedNodeClass(const FNodeGenerateData& GenerateData) const
 {
-    AInteractiveNode* Source = GetNode(SourceID);
-    AInteractiveNode* Target = GetNode(TargetID);
-
-    if (!Source || !Target)
+    if (GenerateData.NodeClass)
     {
-        return nullptr;
+        return GenerateData.NodeClass;
     }
+    return GenerateData.NodeData.NodeType == ENodeType::Scene ? DefaultSceneNodeClass : DefaultItemNodeClass;
+}
 
-    FNodeRelationData RelationData;
-    RelationData.SourceNodeID = SourceID;
-    RelationData.TargetNodeID = TargetID;
-    RelationData.RelationType = Type;
-    RelationData.Weight = 1.0f;
+void ANodeSystemManager::RollbackGraphDelta(const TArray<ANodeConnection*>& CreatedConnections, const TArray<AInteractiveNode*>& CreatedNodes)
+{
+    // 先移除连接，前置计数随之还原
+    RemoveConnections(CreatedConnections);
 
-    return CreateConnection(Source, Target, RelationData);
+    for (AInteractiveNode* Node : CreatedNodes)
+    {
+        UnregisterNode(Node);
+        Node->Destroy();
+    }
 }
 
-bool ANodeSystemManager::RemoveConnection(ANodeConnection* Connection)
+void ANodeSystemManager::ApplyNodePropertyDelta(AInteractiveNode* Node, const FNodePropertyDelta& PropertyDelta)
 {
-    if (!Connection)
+    for (const FString& Key : PropertyDelta.RemovedProperties)
     {
-        return false;
+        Node->NodeData.CustomProperties.Remove(Key);
     }
-
-    // 从注册表移除
-    FString SourceID = Connection->GetSourceNode() ? Connection->GetSourceNode()->GetNodeID() : "";
-    FString TargetID = Connection->GetTargetNode() ? Connection->GetTargetNode()->GetNodeID() : "";
-
-    bool bRemoved = false;
-
-    if (ConnectionRegistry.Contains(SourceID))
+    for (const TPair<FString, FString>& Property : PropertyDelta.SetProperties)
     {
-        ConnectionRegistry[SourceID].Remove(Connection);
-        if (ConnectionRegistry[SourceID].Num() == 0)
-        {
-            ConnectionRegistry.Remove(SourceID);
-        }
-        bRemoved = true;
+        Node->NodeData.CustomProperties.Add(Property.Key, Property.Value);
     }
 
-    if (ConnectionRegistry.Contains(TargetID))
+    // 标签变化时只重建该节点的标签索引
+    if (PropertyDelta.AddedTags.IsEmpty() && PropertyDelta.RemovedTags.IsEmpty())
     {
-        ConnectionRegistry[TargetID].Remove(Connection);
-        if (ConnectionRegistry[TargetID].Num() == 0)
-        {
-            ConnectionRegistry.Remove(TargetID);
-        }
+        return;
     }
 
-    // 从活动连接移除
-    ActiveConnections.Remove(Connection);
+    UpdateNodeTagMap(Node, false);
+    Node->NodeData.NodeTags.RemoveTags(PropertyDelta.RemovedTags);
+    Node->NodeData.NodeTags.AppendTags(PropertyDelta.AddedTags);
+    UpdateNodeTagMap(Node, true);
+}
 
-    // 注销事件
-    UnregisterConnectionEvents(Connection);
+// 节点查询实现
+AInteractiveNode* ANodeSystemManager::GetNode(const FString& NodeID) const
+{
+    const FNodeHandle* Handle = NodeIDTable.Find(NodeID);
+    return Handle ? GetNodeByHandle(*Handle) : nullptr;
+}
 
-    // 广播事件
-    OnConnectionRemoved.Broadcast(Connection);
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByType(ENodeType Type) const
+{
+    return TArray<AInteractiveNode*>(GetNodesByTypeView(Type));
+}
 
-    // 销毁连接
-    Connection->Destroy();
+TConstArrayView<AInteractiveNode*> ANodeSystemManager::GetNodesByTypeView(ENodeType Type) const
+{
+    if (const TArray<AInteractiveNode*>* Nodes = NodeTypeMap.Find(Type))
+    {
+        return *Nodes;
+    }
+    return TConstArrayView<AInteractiveNode*>();
+}
 
-    return bRemoved;
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByState(ENodeState State) const
+{
+    return GetNodesInState(State);
 }
 
-int32 ANodeSystemManager::RemoveConnectionsBetween(const FString& NodeA, const FString& NodeB)
+const TArray<AInteractiveNode*>& ANodeSystemManager::GetNodesInState(ENodeState State) const
 {
-    int32 RemovedCount = 0;
-    TArray<ANodeConnection*> ConnectionsToRemove;
+    static const TArray<AInteractiveNode*> EmptyBucket;
 
-    // 查找所有相关连接
-    if (ConnectionRegistry.Contains(NodeA))
-    {
-        for (ANodeConnection* Connection : ConnectionRegistry[NodeA])
-        {
-            if (Connection && Connection->IsConnecting(GetNode(NodeA), GetNode(NodeB)))
-            {
-                ConnectionsToRemove.AddUnique(Connection);
-            }
-        }
-    }
+    const int32 BucketIndex = static_cast<int32>(State);
+    return StateBuckets.IsValidIndex(BucketIndex) ? StateBuckets[BucketIndex].Nodes : EmptyBucket;
+}
 
-    // 移除连接
-    for (ANodeConnection* Connection : ConnectionsToRemove)
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesByTag(const FGameplayTag& Tag) const
+{
+    if (const TArray<AInteractiveNode*>* Nodes = NodeTagMap.Find(Tag))
     {
-        if (RemoveConnection(Connection))
-        {
-            RemovedCount++;
-        }
+        return *Nodes;
     }
+    return TArray<AInteractiveNode*>();
+}
 
-    return RemovedCount;
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesInRadius(const FVector& Center, float Radius) const
+{
+    TArray<int32> SlotIndices;
+    NodeSpatialIndex.QueryRadius(Center, Radius, SlotIndices);
+    return GetNodesFromSlots(SlotIndices);
 }
 
-int32 ANodeSystemManager::RemoveAllConnectionsForNode(const FString& NodeID)
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesInBox(const FBox& Box) const
 {
-    int32 RemovedCount = 0;
-    TArray<ANodeConnection*> ConnectionsToRemove;
+    TArray<int32> SlotIndices;
+    NodeSpatialIndex.QueryBox(Box, SlotIndices);
+    return GetNodesFromSlots(SlotIndices);
+}
 
-    // 收集所有相关连接
-    if (ConnectionRegistry.Contains(NodeID))
+TArray<AInteractiveNode*> ANodeSystemManager::GetNearestNodes(const FVector& Center, int32 Count, float MaxRadius) const
+{
+    TArray<int32> SlotIndices;
+    NodeSpatialIndex.QueryNearest(Center, Count, MaxRadius, SlotIndices);
+    return GetNodesFromSlots(SlotIndices);
+}
+
+void ANodeSystemManager::UpdateNodeLocation(AInteractiveNode* Node)
+{
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (Handle.IsValid())
     {
-        ConnectionsToRemove = ConnectionRegistry[NodeID];
+        NodeSpatialIndex.Update(Handle.Index, Node->GetActorLocation());
+        MarkConnectionTransformsDirty(Handle);
+        GraphDebugRenderer->MarkGeometryDirty();
     }
+}
 
-    // 移除连接
-    for (ANodeConnection* Connection : ConnectionsToRemove)
+void ANodeSystemManager::MarkConnectionTransformsDirty(const FNodeHandle& Handle)
+{
+    for (ANodeConnection* Connection : NodeSlots[Handle.Index].Connections)
     {
-        if (RemoveConnection(Connection))
+        if (Connection && !Connection->bTransformDirty)
         {
-            RemovedCount++;
+            Connection->bTransformDirty = true;
+            DirtyConnectionTransforms.Add(Connection);
         }
     }
-
-    return RemovedCount;
 }
 
-// 连接查询实现
-ANodeConnection* ANodeSystemManager::GetConnection(const FString& SourceID, const FString& TargetID) const
+void ANodeSystemManager::UpdateDirtyConnectionTransforms()
 {
-    if (!ConnectionRegistry.Contains(SourceID))
+    // 已移除的连接在摘除索引时清除了脏标记
+    TArray<ANodeConnection*> Connections;
+    Connections.Reserve(DirtyConnectionTransforms.Num());
+    for (ANodeConnection* Connection : DirtyConnectionTransforms)
     {
-        return nullptr;
+        if (Connection && Connection->bTransformDirty)
+        {
+            Connection->bTransformDirty = false;
+            if (Connection->IsValid())
+            {
+                Connections.Add(Connection);
+            }
+        }
     }
+    DirtyConnectionTransforms.Reset();
+
+    // 变换只读取端点位置，可以并行计算；写入留在游戏线程
+    TArray<FTransform> Transforms;
+    Transforms.SetNumUninitialized(Connections.Num());
+    ParallelFor(Connections.Num(), [&Connections, &Transforms](int32 Index)
+    {
+        Transforms[Index] = Connections[Index]->GetConnectionTransform();
+    }, Connections.Num() < 64 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 
-    for (ANodeConnection* Connection : ConnectionRegistry[SourceID])
+    ConnectionRenderer->ApplyConnectionTransforms(Connections, Transforms);
+    for (int32 Index = 0; Index < Connections.Num(); ++Index)
     {
-        if (Connection && Connection->GetTargetNode() && 
-            Connection->GetTargetNode()->GetNodeID() == TargetID)
+        if (!Connections[Index]->IsInstancedRendered())
         {
-            return Connection;
+            Connections[Index]->ApplyConnectionTransform(Transforms[Index]);
         }
     }
-
-    return nullptr;
 }
 
-TArray<ANodeConnection*> ANodeSystemManager::GetConnectionsForNode(const FString& NodeID) const
+void ANodeSystemManager::UpdateSignificance(double BudgetSeconds)
 {
-    if (ConnectionRegistry.Contains(NodeID))
+    APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+    if (!CameraManager || NodeSlots.Num() == 0)
     {
-        return ConnectionRegistry[NodeID];
+        return;
     }
-    return TArray<ANodeConnection*>();
-}
 
-TArray<ANodeConnection*> ANodeSystemManager::GetOutgoingConnections(const FString& NodeID) const
-{
-    TArray<ANodeConnection*> Result;
+    const FMinimalViewInfo& ViewInfo = CameraManager->GetCameraCacheView();
+    FMatrix ViewMatrix;
+    FMatrix ProjectionMatrix;
+    FMatrix ViewProjectionMatrix;
+    UGameplayStatics::GetViewProjectionMatrix(ViewInfo, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+    FConvexVolume ViewFrustum;
+    GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, false);
+
+    FNodeSignificanceSettings Settings;
+    Settings.FullDistance = SignificanceFullDistance;
+    Settings.ReducedDistance = SignificanceReducedDistance;
+    Settings.MinimalDistance = SignificanceMinimalDistance;
+    Settings.Hysteresis = SignificanceHysteresis;
+
+    // 相机附近的节点最多占用一半预算，轮转每帧至少评估固定数量的节点，避免远处节点饿死
+    constexpr int32 MinRoundRobinPerFrame = 32;
+    const double StartTime = FPlatformTime::Seconds();
+    const double NearEndTime = StartTime + BudgetSeconds * 0.5;
+    const double EndTime = StartTime + BudgetSeconds;
+
+    // 相机附近（可能为Full）的节点优先，靠近时不必等轮转
+    TArray<int32> NearSlots;
+    NodeSpatialIndex.QueryRadius(ViewInfo.Location, SignificanceFullDistance * (1.0f + SignificanceHysteresis), NearSlots);
+    int32 NearEvaluated = 0;
+    for (int32 SlotIndex : NearSlots)
+    {
+        if (NearEvaluated > 0 && FPlatformTime::Seconds() >= NearEndTime)
+        {
+            break;
+        }
+        EvaluateNodeSignificance(SlotIndex, ViewInfo.Location, ViewFrustum, Settings);
+        ++NearEvaluated;
+    }
+
+    // 其余节点轮转评估，一轮最多覆盖全部槽位
+    const int32 SlotCount = NodeSlots.Num();
+    int32 RoundRobinEvaluated = 0;
+    for (int32 Step = 0; Step < SlotCount; ++Step)
+    {
+        if (RoundRobinEvaluated >= MinRoundRobinPerFrame && FPlatformTime::Seconds() >= EndTime)
+        {
+            break;
+        }
+
+        const int32 SlotIndex = NodeSignificance.AdvanceCursor(SlotCount);
+        if (NodeSlots[SlotIndex].Node)
+        {
+            EvaluateNodeSignificance(SlotIndex, ViewInfo.Location, ViewFrustum, Settings);
+            ++RoundRobinEvaluated;
+        }
+    }
+}
+
+void ANodeSystemManager::EvaluateNodeSignificance(int32 SlotIndex, const FVector& ViewLocation, const FConvexVolume& ViewFrustum, const FNodeSignificanceSettings& Settings)
+{
+    AInteractiveNode* Node = NodeSlots[SlotIndex].Node;
+    if (!Node)
+    {
+        return;
+    }
+
+    const FVector Location = NodeSpatialIndex.Contains(SlotIndex) ? NodeSpatialIndex.GetLocation(SlotIndex) : Node->GetActorLocation();
+
+    FNodeSignificanceInput Input;
+    Input.DistanceSquared = FVector::DistSquared(ViewLocation, Location);
+    Input.bInFrustum = ViewFrustum.IntersectSphere(Location, SignificanceBoundsRadius);
+    Input.bInActiveScene = IsSlotInActiveScene(SlotIndex);
+
+    const ENodeSignificanceTier NewTier = FNodeSignificanceTracker::EvaluateTier(Input, NodeSignificance.GetTier(SlotIndex), Settings);
+    if (!NodeSignificance.SetTier(SlotIndex, NewTier))
+    {
+        return;
+    }
+
+    Node->ApplySignificanceTier(NewTier);
+    for (ANodeConnection* Connection : NodeSlots[SlotIndex].Connections)
+    {
+        ApplyConnectionSignificance(Connection);
+    }
+}
+
+bool ANodeSystemManager::IsSlotInActiveScene(int32 SlotIndex) const
+{
+    const FNodeHandle SceneHandle = GetRegisteredHandle(ActiveSceneNode);
+    if (!SceneHandle.IsValid() || SlotIndex == SceneHandle.Index)
+    {
+        return true;
+    }
+
+    // 不属于任何场景或连接层级的节点视为全局节点
+    if (NodeHierarchy.GetParent(SlotIndex) == INDEX_NONE)
+    {
+        return true;
+    }
+
+    return NodeHierarchy.IsAncestorOf(SceneHandle.Index, SlotIndex);
+}
+
+void ANodeSystemManager::ApplyConnectionSignificance(ANodeConnection* Connection)
+{
+    if (!Connection)
+    {
+        return;
+    }
+
+    const FNodeHandle SourceHandle = GetRegisteredHandle(Connection->GetSourceNode());
+    const FNodeHandle TargetHandle = GetRegisteredHandle(Connection->GetTargetNode());
+    const ENodeSignificanceTier SourceTier = NodeSignificance.GetTier(SourceHandle.Index);
+    const ENodeSignificanceTier TargetTier = NodeSignificance.GetTier(TargetHandle.Index);
+    Connection->ApplySignificanceTier(FMath::Min(SourceTier, TargetTier));
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodesFromSlots(const TArray<int32>& SlotIndices) const
+{
+    TArray<AInteractiveNode*> Result;
+    Result.Reserve(SlotIndices.Num());
+
+    for (int32 SlotIndex : SlotIndices)
+    {
+        if (NodeSlots.IsValidIndex(SlotIndex) && NodeSlots[SlotIndex].Node)
+        {
+            Result.Add(NodeSlots[SlotIndex].Node);
+        }
+    }
+
+    return Result;
+}
+
+TArray<AItemNode*> ANodeSystemManager::FindNodesWithCapability(TSubclassOf<UItemCapability> CapabilityClass) const
+{
+    TArray<AItemNode*> Result;
+    
+    if (!CapabilityClass)
+    {
+        return Result;
+    }
     
-    if (ConnectionRegistry.Contains(NodeID))
+    for (const FNodeSlot& Slot : NodeSlots)
+    {
+        if (AItemNode* ItemNode = Cast<AItemNode>(Slot.Node))
+        {
+            if (ItemNode->HasCapability(CapabilityClass))
+            {
+                Result.Add(ItemNode);
+            }
+        }
+    }
+    
+    return Result;
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::GetAllNodes() const
+{
+    TArray<AInteractiveNode*> Result;
+    Result.Reserve(NodeIDTable.Num());
+
+    for (const FNodeSlot& Slot : NodeSlots)
+    {
+        if (Slot.Node)
+        {
+            Result.Add(Slot.Node);
+        }
+    }
+
+    return Result;
+}
+
+TMap<FString, AInteractiveNode*> ANodeSystemManager::GetNodeRegistry() const
+{
+    TMap<FString, AInteractiveNode*> Result;
+    Result.Reserve(NodeIDTable.Num());
+
+    for (const TPair<FString, FNodeHandle>& Entry : NodeIDTable)
+    {
+        if (AInteractiveNode* Node = GetNodeByHandle(Entry.Value))
+        {
+            Result.Add(Entry.Key, Node);
+        }
+    }
+
+    return Result;
+}
+
+// 句柄查询实现
+FNodeHandle ANodeSystemManager::FindNodeHandle(const FString& NodeID) const
+{
+    const FNodeHandle* Handle = NodeIDTable.Find(NodeID);
+    return Handle ? *Handle : FNodeHandle();
+}
+
+AInteractiveNode* ANodeSystemManager::GetNodeByHandle(const FNodeHandle& Handle) const
+{
+    const FNodeSlot* Slot = FindNodeSlot(Handle);
+    return Slot ? Slot->Node : nullptr;
+}
+
+bool ANodeSystemManager::IsNodeHandleValid(const FNodeHandle& Handle) const
+{
+    return FindNodeSlot(Handle) != nullptr;
+}
+
+AInteractiveNode* ANodeSystemManager::ResolveNode(const FString& NodeID, FNodeHandle& InOutHandle) const
+{
+    // 缓存句柄仍然存活且ID一致时直接命中，无需字符串哈希
+    const FNodeSlot* Slot = FindNodeSlot(InOutHandle);
+    if (Slot && Slot->NodeID == NodeID)
+    {
+        return Slot->Node;
+    }
+
+    InOutHandle = FindNodeHandle(NodeID);
+    return GetNodeByHandle(InOutHandle);
+}
+
+void ANodeSystemManager::OnPlayerNodeInteractionEvent(AItemNode* Node, EInteractionType Type, bool bIsStarting)
+{
+    if (bIsStarting)
+    {
+        OnInteractionStarted(Node, Type);
+    }
+    else
+    {
+        OnInteractionEnded(Node, Type);
+    }
+}
+
+void ANodeSystemManager::BindPlayerInteractionEvents()
+{
+    if (APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0))
+    {
+        if (AMyProjectCharacter* Player = ((AMyProjectCharacter*)Cast<AMyProjectCharacter>(PC->GetPawn())))
+        {
+            if (UPlayerInteractionManager* InteractionManager = Player->GetInteractionManager())
+            {
+                // 绑定委托
+                InteractionManager->OnNodeInteraction.AddDynamic(this, &ANodeSystemManager::OnPlayerNodeInteractionEvent);
+            }
+        }
+    }
+}
+
+void ANodeSystemManager::OnInteractionStarted(AItemNode* Node, EInteractionType Type)
+{
+    // 根据类型分发
+    switch(Type)
+    {
+        case EInteractionType::Click:
+        case EInteractionType::Hold:
+            OnNodeSelected(Node);
+            break;
+        case EInteractionType::Hover:
+            OnNodeHoverStarted(Node);
+            break;
+        case EInteractionType::Drag:
+            OnNodeDragStarted(Node);
+            break;
+        default:
+            // 其他类型的交互
+            UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Unknown interaction type"));
+            break;
+    }
+}
+
+void ANodeSystemManager::OnInteractionEnded(AItemNode* Node, EInteractionType Type)
+{
+    // 根据类型分发
+    switch(Type)
+    {
+    case EInteractionType::Click:
+    case EInteractionType::Hold:
+        OnNodeDeselected(Node);
+        break;
+    case EInteractionType::Hover:
+        OnNodeHoverEnded(Node);
+        break;
+    case EInteractionType::Drag:
+        OnNodeDragEnded(Node);
+        break;
+    default:
+        // 其他类型的交互
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Unknown interaction type"));
+        break;
+    }
+}
+
+void ANodeSystemManager::OnNodeSelected(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Selected"), *Node->GetNodeName());
+}
+
+void ANodeSystemManager::OnNodeDeselected(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Deselected"), *Node->GetNodeName());
+}
+
+void ANodeSystemManager::OnNodeDragStarted(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Drag"), *Node->GetNodeName());
+}
+
+void ANodeSystemManager::OnNodeDragEnded(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s DragEnd"), *Node->GetNodeName());
+}
+
+void ANodeSystemManager::OnNodeHoverStarted(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s Hover"), *Node->GetNodeName());
+}
+
+void ANodeSystemManager::OnNodeHoverEnded(AItemNode* Node)
+{
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s HoverEnd"), *Node->GetNodeName());
+}
+
+// 连接管理实现
+ANodeConnection* ANodeSystemManager::CreateConnection(AInteractiveNode* Source, AInteractiveNode* Target, const FNodeRelationData& RelationData)
+{
+    if (!Source || !Target)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot create connection without valid nodes"));
+        return nullptr;
+    }
+
+    if (Source == Target)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot create self-connection"));
+        return nullptr;
+    }
+
+    // 连接挂在节点槽位上，端点必须已注册
+    FNodeHandle SourceHandle = GetRegisteredHandle(Source);
+    FNodeHandle TargetHandle = GetRegisteredHandle(Target);
+    if (bAutoRegisterSpawnedNodes)
+    {
+        if (!SourceHandle.IsValid() && RegisterNode(Source))
+        {
+            SourceHandle = Source->GetNodeHandle();
+        }
+        if (!TargetHandle.IsValid() && RegisterNode(Target))
+        {
+            TargetHandle = Target->GetNodeHandle();
+        }
+    }
+
+    if (!SourceHandle.IsValid() || !TargetHandle.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Cannot create connection between unregistered nodes %s and %s"),
+            *Source->GetNodeIDRef(), *Target->GetNodeIDRef());
+        return nullptr;
+    }
+
+    // 检查是否已存在同类型连接（不同关系类型可以并存）
+    ANodeConnection* ExistingConnection = ConnectionEdgeIndex.FindRef(FNodeEdgeKey(SourceHandle, TargetHandle, RelationData.RelationType));
+    if (ExistingConnection)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: %s connection already exists between %s and %s"), 
+            *UEnum::GetValueAsString(RelationData.RelationType), *Source->GetNodeIDRef(), *Target->GetNodeIDRef());
+        return ExistingConnection;
+    }
+
+    // 创建连接
+    UWorld* World = GetWorld();
+    if (!World)
+    {
+        return nullptr;
+    }
+
+    TSubclassOf<ANodeConnection> ConnectionClass = DefaultConnectionClass;
+    if (!ConnectionClass)
+    {
+        ConnectionClass = ANodeConnection::StaticClass();
+    }
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    ANodeConnection* NewConnection = World->SpawnActor<ANodeConnection>(ConnectionClass, SpawnParams);
+    if (NewConnection)
+    {
+        // 初始化连接
+        NewConnection->SetSystemManager(this);
+        NewConnection->Initialize(Source, Target, RelationData.RelationType);
+        NewConnection->SetConnectionWeight(RelationData.Weight);
+        NewConnection->SetBidirectional(RelationData.bBidirectional);
+
+        // 未选择Actor表现的连接由实例化渲染器绘制
+        if (!NewConnection->ShouldUseActorVisuals())
+        {
+            ConnectionRenderer->AddConnection(NewConnection);
+        }
+
+        // 添加到两端节点的槽位
+        NodeSlots[SourceHandle.Index].Connections.Add(NewConnection);
+        if (TargetHandle != SourceHandle)
+        {
+            NodeSlots[TargetHandle.Index].Connections.Add(NewConnection);
+        }
+        AddToEdgeIndex(NewConnection, SourceHandle, TargetHandle);
+        AddPrerequisiteEdge(NewConnection, TargetHandle);
+        NodeComponents.Union(SourceHandle.Index, TargetHandle.Index);
+        MarkGraphDirty();
+
+        // 两端节点已降级时连接随之降级
+        ApplyConnectionSignificance(NewConnection);
+
+        // Parent连接：源节点为父
+        if (RelationData.RelationType == ENodeRelationType::Parent)
+        {
+            NodeHierarchy.AddLinkParent(TargetHandle.Index, SourceHandle.Index);
+        }
+
+        // 添加到活动连接
+        ActiveConnections.Add(NewConnection);
+
+        // 注册事件
+        RegisterConnectionEvents(NewConnection);
+
+        // 广播事件
+        if (!bIsApplyingGraphDelta)
+        {
+            OnConnectionCreated.Broadcast(NewConnection);
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Created connection between %s and %s"), 
+            *Source->GetNodeIDRef(), *Target->GetNodeIDRef());
+    }
+
+    return NewConnection;
+}
+
+ANodeConnection* ANodeSystemManager::CreateConnectionBetween(const FString& SourceID, const FString& TargetID, ENodeRelationType Type)
+{
+    return CreateConnectionByHandle(FindNodeHandle(SourceID), FindNodeHandle(TargetID), Type);
+}
+
+ANodeConnection* ANodeSystemManager::CreateConnectionByHandle(const FNodeHandle& Source, const FNodeHandle& Target, ENodeRelationType Type)
+{
+    const FNodeSlot* SourceSlot = FindNodeSlot(Source);
+    const FNodeSlot* TargetSlot = FindNodeSlot(Target);
+
+    if (!SourceSlot || !TargetSlot)
+    {
+        return nullptr;
+    }
+
+    FNodeRelationData RelationData;
+    RelationData.SourceNodeID = SourceSlot->NodeID;
+    RelationData.TargetNodeID = TargetSlot->NodeID;
+    RelationData.RelationType = Type;
+    RelationData.Weight = 1.0f;
+
+    return CreateConnection(SourceSlot->Node, TargetSlot->Node, RelationData);
+}
+
+bool ANodeSystemManager::RemoveConnection(ANodeConnection* Connection)
+{
+    // 已移除但尚未销毁的连接不再重复摘除，否则前置计数会被多减一次
+    if (!Connection || Connection->bRemovedFromSystem)
+    {
+        return false;
+    }
+
+    // 先按当前端点句柄摘除索引记录
+    DetachConnectionIndices(Connection);
+    NodeComponents.MarkStale();
+    MarkGraphDirty();
+
+    // 从两端节点的槽位移除
+    bool bRemoved = false;
+
+    if (FNodeSlot* SourceSlot = FindNodeSlot(GetRegisteredHandle(Connection->GetSourceNode())))
+    {
+        SourceSlot->Connections.Remove(Connection);
+        bRemoved = true;
+    }
+
+    if (FNodeSlot* TargetSlot = FindNodeSlot(GetRegisteredHandle(Connection->GetTargetNode())))
+    {
+        TargetSlot->Connections.Remove(Connection);
+    }
+
+    // 从活动连接移除
+    ActiveConnections.Remove(Connection);
+
+    // 注销事件
+    UnregisterConnectionEvents(Connection);
+
+    // 广播事件
+    OnConnectionRemoved.Broadcast(Connection);
+
+    // 延迟销毁连接
+    QueueConnectionDestroy(Connection);
+
+    return bRemoved;
+}
+
+int32 ANodeSystemManager::RemoveConnections(const TArray<ANodeConnection*>& Connections)
+{
+    int32 RemovedCount = 0;
+    TSet<ANodeConnection*> DeadConnections;
+    DeadConnections.Reserve(Connections.Num());
+    TArray<ANodeConnection*> RemovedConnections;
+    RemovedConnections.Reserve(Connections.Num());
+    TBitArray<> TouchedSlots(false, NodeSlots.Num());
+
+    // 逐条摘除索引记录并标记为已移除，数组留到最后统一压缩
+    for (ANodeConnection* Connection : Connections)
+    {
+        if (!Connection || Connection->bRemovedFromSystem || DeadConnections.Contains(Connection))
+        {
+            continue;
+        }
+        DeadConnections.Add(Connection);
+
+        const FNodeHandle SourceHandle = GetRegisteredHandle(Connection->GetSourceNode());
+        const FNodeHandle TargetHandle = GetRegisteredHandle(Connection->GetTargetNode());
+        if (SourceHandle.IsValid())
+        {
+            TouchedSlots[SourceHandle.Index] = true;
+            RemovedCount++;
+        }
+        if (TargetHandle.IsValid())
+        {
+            TouchedSlots[TargetHandle.Index] = true;
+        }
+
+        DetachConnectionIndices(Connection);
+        UnregisterConnectionEvents(Connection);
+        RemovedConnections.Add(Connection);
+    }
+
+    if (RemovedConnections.Num() == 0)
+    {
+        return 0;
+    }
+
+    // 每个受影响的槽位和活动连接列表只压缩一次
+    auto IsDead = [&DeadConnections](const ANodeConnection* Connection)
+    {
+        return DeadConnections.Contains(Connection);
+    };
+    for (TConstSetBitIterator<> It(TouchedSlots); It; ++It)
+    {
+        NodeSlots[It.GetIndex()].Connections.RemoveAll(IsDead);
+    }
+    ActiveConnections.RemoveAll(IsDead);
+
+    NodeComponents.MarkStale();
+    MarkGraphDirty();
+
+    // 批量移除只广播一次，不再逐条触发OnConnectionRemoved
+    if (!bIsApplyingGraphDelta)
+    {
+        OnConnectionsRemoved.Broadcast(RemovedConnections);
+    }
+
+    for (ANodeConnection* Connection : RemovedConnections)
+    {
+        QueueConnectionDestroy(Connection);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Removed %d connections"), RemovedConnections.Num());
+    return RemovedCount;
+}
+
+int32 ANodeSystemManager::RemoveConnectionsBetween(const FString& NodeA, const FString& NodeB)
+{
+    TArray<ANodeConnection*, TInlineAllocator<8>> ConnectionsToRemove;
+
+    const FNodeHandle HandleA = FindNodeHandle(NodeA);
+    const FNodeHandle HandleB = FindNodeHandle(NodeB);
+
+    // 按关系类型和方向逐一查哈希索引
+    if (IsNodeHandleValid(HandleA) && IsNodeHandleValid(HandleB))
+    {
+        for (int32 Type = 0; Type < FNodeAdjacencySnapshot::GetNumRelationTypes(); ++Type)
+        {
+            const ENodeRelationType RelationType = static_cast<ENodeRelationType>(Type);
+            if (ANodeConnection* Connection = ConnectionEdgeIndex.FindRef(FNodeEdgeKey(HandleA, HandleB, RelationType)))
+            {
+                ConnectionsToRemove.AddUnique(Connection);
+            }
+            if (ANodeConnection* Connection = ConnectionEdgeIndex.FindRef(FNodeEdgeKey(HandleB, HandleA, RelationType)))
+            {
+                ConnectionsToRemove.AddUnique(Connection);
+            }
+        }
+    }
+
+    // 移除连接
+    return RemoveConnections(TArray<ANodeConnection*>(ConnectionsToRemove));
+}
+
+int32 ANodeSystemManager::RemoveAllConnectionsForNode(const FString& NodeID)
+{
+    return RemoveAllConnectionsForHandle(FindNodeHandle(NodeID));
+}
+
+int32 ANodeSystemManager::RemoveAllConnectionsForHandle(const FNodeHandle& Handle)
+{
+    // 拷贝一份，批量移除会压缩槽位的连接数组
+    const FNodeSlot* Slot = FindNodeSlot(Handle);
+    return Slot ? RemoveConnections(TArray<ANodeConnection*>(Slot->Connections)) : 0;
+}
+
+// 连接查询实现
+ANodeConnection* ANodeSystemManager::GetConnection(const FString& SourceID, const FString& TargetID) const
+{
+    return GetConnectionByHandle(FindNodeHandle(SourceID), FindNodeHandle(TargetID));
+}
+
+ANodeConnection* ANodeSystemManager::GetConnectionOfType(const FString& SourceID, const FString& TargetID, ENodeRelationType RelationType) const
+{
+    return GetConnectionOfTypeByHandle(FindNodeHandle(SourceID), FindNodeHandle(TargetID), RelationType);
+}
+
+ANodeConnection* ANodeSystemManager::GetConnectionByHandle(const FNodeHandle& Source, const FNodeHandle& Target) const
+{
+    if (!IsNodeHandleValid(Source) || !IsNodeHandleValid(Target))
+    {
+        return nullptr;
+    }
+
+    for (int32 Type = 0; Type < FNodeAdjacencySnapshot::GetNumRelationTypes(); ++Type)
+    {
+        if (ANodeConnection* Connection = ConnectionEdgeIndex.FindRef(FNodeEdgeKey(Source, Target, static_cast<ENodeRelationType>(Type))))
+        {
+            return Connection;
+        }
+    }
+
+    return nullptr;
+}
+
+ANodeConnection* ANodeSystemManager::GetConnectionOfTypeByHandle(const FNodeHandle& Source, const FNodeHandle& Target, ENodeRelationType RelationType) const
+{
+    return ConnectionEdgeIndex.FindRef(FNodeEdgeKey(Source, Target, RelationType));
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetConnectionsForNode(const FString& NodeID) const
+{
+    return GetConnectionsForHandle(FindNodeHandle(NodeID));
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetConnectionsForHandle(const FNodeHandle& Handle) const
+{
+    return TArray<ANodeConnection*>(GetConnectionsView(Handle));
+}
+
+TConstArrayView<ANodeConnection*> ANodeSystemManager::GetConnectionsView(const FNodeHandle& Handle) const
+{
+    if (const FNodeSlot* Slot = FindNodeSlot(Handle))
+    {
+        return Slot->Connections;
+    }
+    return TConstArrayView<ANodeConnection*>();
+}
+
+void ANodeSystemManager::ForEachOutgoingConnection(const FNodeHandle& Handle, TFunctionRef<bool(ANodeConnection*)> Visitor) const
+{
+    if (const FNodeSlot* Slot = FindNodeSlot(Handle))
+    {
+        for (ANodeConnection* Connection : Slot->Connections)
+        {
+            if (Connection && Connection->GetSourceNode() == Slot->Node && !Visitor(Connection))
+            {
+                return;
+            }
+        }
+    }
+}
+
+void ANodeSystemManager::ForEachIncomingConnection(const FNodeHandle& Handle, TFunctionRef<bool(ANodeConnection*)> Visitor) const
+{
+    if (const FNodeSlot* Slot = FindNodeSlot(Handle))
+    {
+        for (ANodeConnection* Connection : Slot->Connections)
+        {
+            if (Connection && Connection->GetTargetNode() == Slot->Node && !Visitor(Connection))
+            {
+                return;
+            }
+        }
+    }
+}
+
+void ANodeSystemManager::ForEachConnectedNode(const FNodeHandle& Handle, TFunctionRef<bool(AInteractiveNode*, ANodeConnection*)> Visitor) const
+{
+    if (const FNodeSlot* Slot = FindNodeSlot(Handle))
+    {
+        for (ANodeConnection* Connection : Slot->Connections)
+        {
+            AInteractiveNode* OtherNode = Connection ? Connection->GetOppositeNode(Slot->Node) : nullptr;
+            if (OtherNode && !Visitor(OtherNode, Connection))
+            {
+                return;
+            }
+        }
+    }
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetOutgoingConnections(const FString& NodeID) const
+{
+    return GetOutgoingConnectionsForHandle(FindNodeHandle(NodeID));
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetOutgoingConnectionsForHandle(const FNodeHandle& Handle) const
+{
+    TArray<ANodeConnection*> Result;
+    ForEachOutgoingConnection(Handle, [&Result](ANodeConnection* Connection)
+    {
+        Result.Add(Connection);
+        return true;
+    });
+    return Result;
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetIncomingConnections(const FString& NodeID) const
+{
+    return GetIncomingConnectionsForHandle(FindNodeHandle(NodeID));
+}
+
+TArray<ANodeConnection*> ANodeSystemManager::GetIncomingConnectionsForHandle(const FNodeHandle& Handle) const
+{
+    TArray<ANodeConnection*> Result;
+    ForEachIncomingConnection(Handle, [&Result](ANodeConnection* Connection)
+    {
+        Result.Add(Connection);
+        return true;
+    });
+    return Result;
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::GetConnectedNodes(const FString& NodeID, ENodeRelationType RelationType) const
+{
+    return GetConnectedNodesByHandle(FindNodeHandle(NodeID), RelationType);
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::GetConnectedNodesByHandle(const FNodeHandle& Handle, ENodeRelationType RelationType) const
+{
+    TArray<AInteractiveNode*> Result;
+    if (!IsNodeHandleValid(Handle))
+    {
+        return Result;
+    }
+
+    // 单节点查询直接遍历槽位自身的连接表（O(度)），不触发邻接快照重建
+    const FNodeSlot& Slot = NodeSlots[Handle.Index];
+    TSet<AInteractiveNode*, DefaultKeyFuncs<AInteractiveNode*>, TInlineSetAllocator<16>> Seen;
+    Result.Reserve(Slot.Connections.Num());
+    for (ANodeConnection* Connection : Slot.Connections)
+    {
+        if (!Connection || Connection->RelationType != RelationType)
+        {
+            continue;
+        }
+
+        AInteractiveNode* OtherNode = Connection->GetOppositeNode(Slot.Node);
+        bool bAlreadySeen = false;
+        Seen.Add(OtherNode, &bAlreadySeen);
+        if (OtherNode && !bAlreadySeen)
+        {
+            Result.Add(OtherNode);
+        }
+    }
+    return Result;
+}
+
+const FNodeAdjacencySnapshot& ANodeSystemManager::GetAdjacencySnapshot() const
+{
+    if (AdjacencySnapshot.BuiltVersion != GraphVersion)
+    {
+        // 每条连接同时挂在两端槽位上，只在源节点槽位处收集一次
+        TArray<FNodeAdjacencyEdge> Edges;
+        Edges.Reserve(ActiveConnections.Num());
+        for (int32 SlotIndex = 0; SlotIndex < NodeSlots.Num(); ++SlotIndex)
+        {
+            const FNodeSlot& Slot = NodeSlots[SlotIndex];
+            for (ANodeConnection* Connection : Slot.Connections)
+            {
+                if (!Connection || !Slot.Node || Connection->GetSourceNode() != Slot.Node)
+                {
+                    continue;
+                }
+
+                const FNodeHandle TargetHandle = GetRegisteredHandle(Connection->GetTargetNode());
+                if (TargetHandle.IsValid())
+                {
+                    FNodeAdjacencyEdge& Edge = Edges.AddDefaulted_GetRef();
+                    Edge.Source = SlotIndex;
+                    Edge.Target = TargetHandle.Index;
+                    Edge.RelationType = Connection->RelationType;
+                    Edge.Connection = Connection;
+                }
+            }
+        }
+
+        AdjacencySnapshot.Build(NodeSlots.Num(), Edges);
+        AdjacencySnapshot.BuiltVersion = GraphVersion;
+    }
+
+    return AdjacencySnapshot;
+}
+
+// 场景管理实现
+bool ANodeSystemManager::SetActiveScene(ASceneNode* Scene)
+{
+    if (!Scene)
+    {
+        return false;
+    }
+
+    ASceneNode* OldScene = ActiveSceneNode;
+    ActiveSceneNode = Scene;
+
+    // 停用旧场景
+    if (OldScene && OldScene != Scene)
+    {
+        OldScene->DeactivateScene();
+    }
+
+    // 激活新场景
+    Scene->ActivateScene();
+
+    // 广播事件
+    OnSceneChanged.Broadcast(OldScene, Scene);
+    OnSystemStateChanged.Broadcast(FString::Printf(TEXT("Scene changed to %s"), *Scene->GetNodeName()));
+
+    return true;
+}
+
+void ANodeSystemManager::TransitionToScene(ASceneNode* NewScene, float TransitionDuration)
+{
+    if (!NewScene || NewScene == ActiveSceneNode)
+    {
+        return;
+    }
+
+    bIsTransitioning = true;
+    TransitionProgress = 0.0f;
+    TransitionTargetScene = NewScene;
+
+    // 开始过渡效果
+    FTimerHandle TransitionHandle;
+    GetWorld()->GetTimerManager().SetTimer(TransitionHandle,
+        [this]()
+        {
+            SetActiveScene(TransitionTargetScene);
+            bIsTransitioning = false;
+            TransitionTargetScene = nullptr;
+        },
+        TransitionDuration, false);
+}
+
+// 生成队列实现
+void ANodeSystemManager::QueueNodeGeneration(const FNodeGenerateData& GenerateData)
+{
+    NodeGenerationQueue.Enqueue(GenerateData);
+}
+
+void ANodeSystemManager::QueueConnectionGeneration(const FNodeRelationData& RelationData)
+{
+    ConnectionGenerationQueue.Enqueue(RelationData);
+}
+
+void ANodeSystemManager::ProcessGenerationQueue()
+{
+    ProcessNodeGeneration();
+    ProcessConnectionGeneration();
+}
+
+void ANodeSystemManager::ClearGenerationQueues()
+{
+    NodeGenerationQueue.Empty();
+    ConnectionGenerationQueue.Empty();
+}
+
+// 高级查询实现
+TArray<AInteractiveNode*> ANodeSystemManager::ExecuteNodeQuery(const FNodeQueryParams& QueryParams) const
+{
+    return ExecuteCompiledNodeQuery(CompileNodeQuery(QueryParams));
+}
+
+FCompiledNodeQuery ANodeSystemManager::CompileNodeQuery(const FNodeQueryParams& QueryParams) const
+{
+    FCompiledNodeQuery Query;
+    Query.Params = QueryParams;
+
+    // 类型过滤转为位掩码
+    for (ENodeType Type : QueryParams.NodeTypes)
+    {
+        Query.TypeMask |= 1u << static_cast<uint32>(Type);
+    }
+    Query.bHasTypeFilter = QueryParams.NodeTypes.Num() > 0;
+
+    // 状态过滤转为位掩码：为空表示全部状态，不包含非激活节点时去掉Inactive
+    const uint32 AllStatesMask = (1u << StateBuckets.Num()) - 1;
+    if (QueryParams.NodeStates.Num() > 0)
+    {
+        for (ENodeState State : QueryParams.NodeStates)
+        {
+            Query.StateMask |= 1u << static_cast<uint32>(State);
+        }
+    }
+    else
+    {
+        Query.StateMask = AllStatesMask;
+    }
+    if (!QueryParams.bIncludeInactive)
+    {
+        Query.StateMask &= ~(1u << static_cast<uint32>(ENodeState::Inactive));
+    }
+    Query.bHasStateFilter = (Query.StateMask & AllStatesMask) != AllStatesMask;
+
+    // 标签查询只展开一次
+    Query.TagQuery = FCompiledNodeTagQuery(QueryParams.TagQuery);
+    Query.bHasTagQuery = !QueryParams.TagQuery.IsEmpty();
+
+    Query.MaxDistanceSq = QueryParams.MaxDistance > 0.0f ? QueryParams.MaxDistance * QueryParams.MaxDistance : 0.0f;
+    Query.bCompiled = true;
+
+    return Query;
+}
+
+TArray<AInteractiveNode*> ANodeSystemManager::ExecuteCompiledNodeQuery(const FCompiledNodeQuery& Query) const
+{
+    if (!Query.bCompiled)
+    {
+        return ExecuteNodeQuery(Query.Params);
+    }
+
+    TArray<AInteractiveNode*> Result;
+
+    // 提升不变量：参考点（这里假设使用玩家位置）每次执行只取一次
+    bool bHasDistanceFilter = false;
+    FVector ReferenceLocation = FVector::ZeroVector;
+    if (Query.MaxDistanceSq > 0.0f)
+    {
+        APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+        if (PC && PC->GetPawn())
+        {
+            bHasDistanceFilter = true;
+            ReferenceLocation = PC->GetPawn()->GetActorLocation();
+        }
+    }
+
+    // 估算各候选驱动集合的规模，选最小者驱动遍历
+    ENodeQueryDriver Driver = ENodeQueryDriver::FullScan;
+    int32 BestCost = NodeIDTable.Num();
+
+    auto ConsiderDriver = [&Driver, &BestCost](ENodeQueryDriver Candidate, int32 Cost)
+    {
+        if (Cost < BestCost)
+        {
+            BestCost = Cost;
+            Driver = Candidate;
+        }
+    };
+
+    if (Query.bHasTypeFilter)
+    {
+        int32 Cost = 0;
+        for (uint32 Mask = Query.TypeMask; Mask; Mask &= Mask - 1)
+        {
+            if (const TArray<AInteractiveNode*>* Nodes = NodeTypeMap.Find(static_cast<ENodeType>(FMath::CountTrailingZeros(Mask))))
+            {
+                Cost += Nodes->Num();
+            }
+        }
+        ConsiderDriver(ENodeQueryDriver::TypeBuckets, Cost);
+    }
+
+    if (Query.bHasStateFilter)
+    {
+        int32 Cost = 0;
+        for (uint32 Mask = Query.StateMask; Mask; Mask &= Mask - 1)
+        {
+            Cost += GetNodesInState(static_cast<ENodeState>(FMath::CountTrailingZeros(Mask))).Num();
+        }
+        ConsiderDriver(ENodeQueryDriver::StateBuckets, Cost);
+    }
+
+    if (Query.bHasTagQuery)
+    {
+        // 位集求值本身按字计费
+        const int32 Cost = NodeTagIndex.EstimateMatchCount(Query.TagQuery) + NodeTagIndex.GetSlotCapacity() / 32;
+        ConsiderDriver(ENodeQueryDriver::TagIndex, Cost);
+    }
+
+    if (bHasDistanceFilter)
+    {
+        ConsiderDriver(ENodeQueryDriver::SpatialIndex, NodeSpatialIndex.EstimateRadiusCount(ReferenceLocation, Query.Params.MaxDistance));
+    }
+
+    Result.Reserve(BestCost);
+
+    // 对驱动集合中的每个节点应用其余过滤条件
+    auto AcceptNode = [&](AInteractiveNode* Node, int32 SlotIndex)
+    {
+        if (!Node)
+        {
+            return;
+        }
+
+        if (Driver != ENodeQueryDriver::TypeBuckets && Query.bHasTypeFilter &&
+            !(Query.TypeMask & (1u << static_cast<uint32>(Node->NodeData.NodeType))))
+        {
+            return;
+        }
+
+        if (Driver != ENodeQueryDriver::StateBuckets && Query.bHasStateFilter &&
+            !(Query.StateMask & (1u << static_cast<uint32>(Node->GetNodeState()))))
+        {
+            return;
+        }
+
+        if (Driver != ENodeQueryDriver::TagIndex && Query.bHasTagQuery &&
+            !NodeTagIndex.MatchesNode(Query.TagQuery, SlotIndex))
+        {
+            return;
+        }
+
+        if (Driver != ENodeQueryDriver::SpatialIndex && bHasDistanceFilter &&
+            FVector::DistSquared(Node->GetActorLocation(), ReferenceLocation) > Query.MaxDistanceSq)
+        {
+            return;
+        }
+
+        Result.Add(Node);
+    };
+
+    switch (Driver)
     {
-        for (ANodeConnection* Connection : ConnectionRegistry[NodeID])
+        case ENodeQueryDriver::TypeBuckets:
+        {
+            for (uint32 Mask = Query.TypeMask; Mask; Mask &= Mask - 1)
+            {
+                if (const TArray<AInteractiveNode*>* Nodes = NodeTypeMap.Find(static_cast<ENodeType>(FMath::CountTrailingZeros(Mask))))
+                {
+                    for (AInteractiveNode* Node : *Nodes)
+                    {
+                        AcceptNode(Node, Node ? Node->NodeHandle.Index : INDEX_NONE);
+                    }
+                }
+            }
+            break;
+        }
+        case ENodeQueryDriver::StateBuckets:
+        {
+            for (uint32 Mask = Query.StateMask; Mask; Mask &= Mask - 1)
+            {
+                for (AInteractiveNode* Node : GetNodesInState(static_cast<ENodeState>(FMath::CountTrailingZeros(Mask))))
+                {
+                    AcceptNode(Node, Node ? Node->NodeHandle.Index : INDEX_NONE);
+                }
+            }
+            break;
+        }
+        case ENodeQueryDriver::TagIndex:
+        {
+            for (TConstSetBitIterator<> It(NodeTagIndex.Evaluate(Query.TagQuery)); It; ++It)
+            {
+                const int32 SlotIndex = It.GetIndex();
+                AcceptNode(NodeSlots.IsValidIndex(SlotIndex) ? NodeSlots[SlotIndex].Node : nullptr, SlotIndex);
+            }
+            break;
+        }
+        case ENodeQueryDriver::SpatialIndex:
         {
-            if (Connection && Connection->GetSourceNode() && 
-                Connection->GetSourceNode()->GetNodeID() == NodeID)
+            TArray<int32> SlotsInRange;
+            NodeSpatialIndex.QueryRadius(ReferenceLocation, Query.Params.MaxDistance, SlotsInRange);
+            for (int32 SlotIndex : SlotsInRange)
             {
-                Result.Add(Connection);
+                AcceptNode(NodeSlots.IsValidIndex(SlotIndex) ? NodeSlots[SlotIndex].Node : nullptr, SlotIndex);
             }
+            break;
+        }
+        default:
+        {
+            for (int32 SlotIndex = 0; SlotIndex < NodeSlots.Num(); ++SlotIndex)
+            {
+                AcceptNode(NodeSlots[SlotIndex].Node, SlotIndex);
+            }
+            break;
         }
     }
     
     return Result;
 }
 
-TArray<ANodeConnection*> ANodeSystemManager::GetIncomingConnections(const FString& NodeID) const
+TArray<AInteractiveNode*> ANodeSystemManager::FindPath(AInteractiveNode* Start, AInteractiveNode* End) const
 {
-    TArray<ANodeConnection*> Result;
+    TArray<AInteractiveNode*> Path;
     
-    if (ConnectionRegistry.Contains(NodeID))
+    if (!Start || !End || Start == End)
+    {
+        return Path;
+    }
+
+    const FNodeHandle StartHandle = GetRegisteredHandle(Start);
+    const FNodeHandle EndHandle = GetRegisteredHandle(End);
+    if (!StartHandle.IsValid() || !EndHandle.IsValid())
+    {
+        return Path;
+    }
+
+    // 在邻接快照上做无向BFS，访问标记用位集，前驱按槽位索引记录
+    const FNodeAdjacencySnapshot& Graph = GetAdjacencySnapshot();
+    const FNodeAdjacencyList& Undirected = Graph.GetList(ENodeEdgeDirection::Undirected);
+    const int32 NumSlots = Graph.GetNumSlots();
+    if (!Graph.IsValidSlot(StartHandle.Index) || !Graph.IsValidSlot(EndHandle.Index))
+    {
+        return Path;
+    }
+
+    TBitArray<> Visited(false, NumSlots);
+    TArray<int32> CameFrom;
+    CameFrom.SetNumUninitialized(NumSlots);
+    TArray<int32> Queue;
+    Queue.Reserve(NodeIDTable.Num());
+
+    Queue.Add(StartHandle.Index);
+    Visited[StartHandle.Index] = true;
+    CameFrom[StartHandle.Index] = StartHandle.Index;
+
+    for (int32 Head = 0; Head < Queue.Num(); ++Head)
     {
-        for (ANodeConnection* Connection : ConnectionRegistry[NodeID])
+        const int32 Current = Queue[Head];
+        if (Current == EndHandle.Index)
         {
-            if (Connection && Connection->GetTargetNode() && 
-                Connection->GetTargetNode()->GetNodeID() == NodeID)
+            // 重建路径
+            for (int32 Index = Current; Index != StartHandle.Index; Index = CameFrom[Index])
             {
-                Result.Add(Connection);
+                Path.Add(NodeSlots[Index].Node);
             }
+            Path.Add(Start);
+            Algo::Reverse(Path);
+            break;
         }
-    }
-    
-    return Result;
-}
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetConnectedNodes(const FString& NodeID, ENodeRelationType RelationType) const
-{
-    TArray<AInteractiveNode*> Result;
-    TArray<ANodeConnection*> Connections = GetConnectionsForNode(NodeID);
-    
-    for (ANodeConnection* Connection : Connections)
-    {
-        if (Connection && Connection->RelationType == RelationType)
+        const FNodeEdgeRange Edges = Graph.GetAllEdges(Current, ENodeEdgeDirection::Undirected);
+        for (int32 Edge = Edges.Begin; Edge < Edges.End; ++Edge)
         {
-            AInteractiveNode* OtherNode = Connection->GetOppositeNode(GetNode(NodeID));
-            if (OtherNode)
+            const int32 Neighbor = Undirected.Neighbors[Edge];
+            if (!Visited[Neighbor])
             {
-                Result.AddUnique(OtherNode);
+                Visited[Neighbor] = true;
+                CameFrom[Neighbor] = Current;
+                Queue.Add(Neighbor);
             }
         }
     }
-    
-    return Result;
+
+    return Path;
 }
 
-// 场景管理实现
-bool ANodeSystemManager::SetActiveScene(ASceneNode* Scene)
+FNodePathResult ANodeSystemManager::FindWeightedPath(AInteractiveNode* Start, AInteractiveNode* End, const FNodePathQuery& Query) const
 {
-    if (!Scene)
+    FNodePathResult Result;
+
+    const FNodeHandle StartHandle = GetRegisteredHandle(Start);
+    const FNodeHandle EndHandle = GetRegisteredHandle(End);
+    if (!StartHandle.IsValid() || !EndHandle.IsValid())
     {
-        return false;
+        return Result;
     }
 
-    ASceneNode* OldScene = ActiveSceneNode;
-    ActiveSceneNode = Scene;
-
-    // 停用旧场景
-    if (OldScene && OldScene != Scene)
+    FNodePathfinder::FSettings Settings;
+    Settings.Algorithm = Query.Algorithm;
+    Settings.MaxCost = Query.MaxCost;
+    Settings.RelationMask = Query.RelationTypes.Num() > 0 ? 0 : FNodeAdjacencySnapshot::GetAllRelationsMask();
+    for (ENodeRelationType RelationType : Query.RelationTypes)
     {
-        OldScene->DeactivateScene();
+        Settings.RelationMask |= 1u << static_cast<uint32>(RelationType);
     }
 
-    // 激活新场景
-    Scene->ActivateScene();
+    // 位置取自空间索引，搜索过程中不访问Actor
+    auto GetSlotLocation = [this](int32 SlotIndex) -> FVector
+    {
+        return NodeSpatialIndex.Contains(SlotIndex) ? NodeSpatialIndex.GetLocation(SlotIndex) : NodeSlots[SlotIndex].Node->GetActorLocation();
+    };
+    const FVector GoalLocation = GetSlotLocation(EndHandle.Index);
 
-    // 广播事件
-    OnSceneChanged.Broadcast(OldScene, Scene);
-    OnSystemStateChanged.Broadcast(FString::Printf(TEXT("Scene changed to %s"), *Scene->GetNodeName()));
+    auto EdgeCost = [&Query, &GetSlotLocation](int32 From, int32 To, ANodeConnection* Connection, bool bAgainstDirection) -> float
+    {
+        const bool bAllowed = Query.Direction == ENodePathDirection::Undirected
+            || Connection->bIsBidirectional
+            || bAgainstDirection == (Query.Direction == ENodePathDirection::Reverse);
+        if (!bAllowed)
+        {
+            return -1.0f;
+        }
 
-    return true;
+        float Cost = FVector::Dist(GetSlotLocation(From), GetSlotLocation(To)) * Query.DistanceCostScale + Query.HopCost;
+        if (Query.bUseConnectionWeight)
+        {
+            // 权重越高的连接越"近"，乘数在[1, 2]之间
+            Cost *= 2.0f - FMath::Clamp(Connection->ConnectionWeight, 0.0f, 1.0f);
+        }
+        return Cost;
+    };
+
+    auto Heuristic = [&Query, &GetSlotLocation, &GoalLocation](int32 SlotIndex) -> float
+    {
+        return FVector::Dist(GetSlotLocation(SlotIndex), GoalLocation) * Query.DistanceCostScale;
+    };
+
+    FNodePathfinder::FResult PathResult;
+    FNodePathfinder(GetAdjacencySnapshot()).FindPath(StartHandle.Index, EndHandle.Index, Settings, EdgeCost, Heuristic, PathResult);
+
+    Result.bFound = PathResult.bFound;
+    Result.TotalCost = PathResult.TotalCost;
+    Result.NodesExpanded = PathResult.NodesExpanded;
+    Result.Connections = MoveTemp(PathResult.Connections);
+    Result.Nodes.Reserve(PathResult.Slots.Num());
+    for (int32 SlotIndex : PathResult.Slots)
+    {
+        Result.Nodes.Add(NodeSlots[SlotIndex].Node);
+    }
+
+    return Result;
 }
 
-void ANodeSystemManager::TransitionToScene(ASceneNode* NewScene, float TransitionDuration)
+int32 ANodeSystemManager::AnalyzeRelationGraph()
 {
-    if (!NewScene || NewScene == ActiveSceneNode)
+    RelationAnalysis.Analyze(GetAdjacencySnapshot(), GetGatingRelationMask());
+
+    const TConstArrayView<int32> CyclicComponents = RelationAnalysis.GetCyclicComponents();
+    for (int32 Component : CyclicComponents)
     {
-        return;
-    }
+        TArray<AInteractiveNode*> CycleNodes = GetNodesFromSlots(TArray<int32>(RelationAnalysis.GetComponent(Component)));
 
-    bIsTransitioning = true;
-    TransitionProgress = 0.0f;
-    TransitionTargetScene = NewScene;
+        FString NodeIDs;
+        for (const AInteractiveNode* Node : CycleNodes)
+        {
+            NodeIDs += (NodeIDs.IsEmpty() ? TEXT("") : TEXT(", ")) + Node->GetNodeIDRef();
+        }
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Gating relation cycle detected: %s"), *NodeIDs);
 
-    // 开始过渡效果
-    FTimerHandle TransitionHandle;
-    GetWorld()->GetTimerManager().SetTimer(TransitionHandle,
-        [this]()
+        OnRelationCycleDetected.Broadcast(CycleNodes);
+    }
+
+    const int32 NumCycles = CyclicComponents.Num();
+    if (NumCycles > 0 && CyclePolicy == ENodeCyclePolicy::BreakCycles)
+    {
+        // 移除回边后图无环，重新分析以得到准确的层级
+        const TArray<ANodeConnection*> CycleEdges(RelationAnalysis.GetCycleEdges());
+        for (ANodeConnection* Connection : CycleEdges)
         {
-            SetActiveScene(TransitionTargetScene);
-            bIsTransitioning = false;
-            TransitionTargetScene = nullptr;
-        },
-        TransitionDuration, false);
+            UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Breaking cycle edge %s -> %s"),
+                *Connection->GetSourceNode()->GetNodeIDRef(), *Connection->GetTargetNode()->GetNodeIDRef());
+        }
+        RemoveConnections(CycleEdges);
+        RelationAnalysis.Analyze(GetAdjacencySnapshot(), GetGatingRelationMask());
+    }
+
+    return NumCycles;
 }
 
-// 生成队列实现
-void ANodeSystemManager::QueueNodeGeneration(const FNodeGenerateData& GenerateData)
+int32 ANodeSystemManager::GetUnlockRank(AInteractiveNode* Node) const
 {
-    NodeGenerationQueue.Enqueue(GenerateData);
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    return Handle.IsValid() ? RelationAnalysis.GetUnlockRank(Handle.Index) : 0;
 }
 
-void ANodeSystemManager::QueueConnectionGeneration(const FNodeRelationData& RelationData)
+TArray<AInteractiveNode*> ANodeSystemManager::GetUnlockOrder() const
 {
-    ConnectionGenerationQueue.Enqueue(RelationData);
+    return GetNodesFromSlots(TArray<int32>(RelationAnalysis.GetTopologicalOrder()));
 }
 
-void ANodeSystemManager::ProcessGenerationQueue()
+int32 ANodeSystemManager::GetNodeComponentCount() const
 {
-    ProcessNodeGeneration();
-    ProcessConnectionGeneration();
+    return GetNodeComponents().GetNumPartitions();
 }
 
-void ANodeSystemManager::ClearGenerationQueues()
+int32 ANodeSystemManager::GetNodeComponentIndex(AInteractiveNode* Node) const
 {
-    NodeGenerationQueue.Empty();
-    ConnectionGenerationQueue.Empty();
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    return Handle.IsValid() ? GetNodeComponents().GetPartitionOfSlot(Handle.Index) : INDEX_NONE;
 }
 
-// 高级查询实现
-TArray<AInteractiveNode*> ANodeSystemManager::ExecuteNodeQuery(const FNodeQueryParams& QueryParams) const
+TArray<AInteractiveNode*> ANodeSystemManager::GetComponentNodes(AInteractiveNode* Node) const
 {
-    TArray<AInteractiveNode*> Result;
-    
-    for (const auto& Pair : NodeRegistry)
-    {
-        AInteractiveNode* Node = Pair.Value;
-        if (!Node)
-        {
-            continue;
-        }
-
-        // 检查节点类型
-        if (QueryParams.NodeTypes.Num() > 0 && 
-            !QueryParams.NodeTypes.Contains(Node->GetNodeData().NodeType))
-        {
-            continue;
-        }
-
-        // 检查节点状态
-        if (QueryParams.NodeStates.Num() > 0 && 
-            !QueryParams.NodeStates.Contains(Node->GetNodeState()))
-        {
-            continue;
-        }
+    const FNodeComponentIndex& Components = GetNodeComponents();
+    return GetNodesFromSlots(TArray<int32>(Components.GetPartition(GetNodeComponentIndex(Node))));
+}
 
-        // 检查标签
-        if (QueryParams.TagQuery.IsEmpty() == false)
-        {
-            FGameplayTagContainer NodeTags = Node->GetNodeData().NodeTags;
-            if (!QueryParams.TagQuery.Matches(NodeTags))
-            {
-                continue;
-            }
-        }
+bool ANodeSystemManager::AreNodesConnected(AInteractiveNode* NodeA, AInteractiveNode* NodeB) const
+{
+    const FNodeHandle HandleA = GetRegisteredHandle(NodeA);
+    const FNodeHandle HandleB = GetRegisteredHandle(NodeB);
+    return HandleA.IsValid() && HandleB.IsValid() && GetNodeComponents().IsConnected(HandleA.Index, HandleB.Index);
+}
 
-        // 检查距离
-        if (QueryParams.MaxDistance > 0.0f)
+const FNodeComponentIndex& ANodeSystemManager::GetNodeComponents() const
+{
+    if (NodeComponents.IsStale())
+    {
+        NodeComponents.Rebuild(GetAdjacencySnapshot(), [this](int32 SlotIndex)
         {
-            // 需要一个参考点，这里假设使用玩家位置
-            APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-            if (PC && PC->GetPawn())
-            {
-                float Distance = FVector::Dist(Node->GetActorLocation(), PC->GetPawn()->GetActorLocation());
-                if (Distance > QueryParams.MaxDistance)
-                {
-                    continue;
-                }
-            }
-        }
+            return !NodeSlots[SlotIndex].NodeID.IsEmpty();
+        });
+    }
+    return NodeComponents;
+}
 
-        // 检查是否包含非激活节点
-        if (!QueryParams.bIncludeInactive && Node->GetNodeState() == ENodeState::Inactive)
-        {
-            continue;
-        }
+void ANodeSystemManager::ParallelForEachComponent(TFunctionRef<void(int32, TConstArrayView<int32>)> Task) const
+{
+    // 分区在游戏线程上生成，任务中只读
+    const FNodeComponentIndex& Components = GetNodeComponents();
+    const int32 NumComponents = Components.GetNumPartitions();
 
-        Result.Add(Node);
-    }
-    
-    return Result;
+    ParallelFor(NumComponents, [&Components, &Task](int32 Component)
+    {
+        Task(Component, Components.GetPartition(Component));
+    });
 }
 
-TArray<AInteractiveNode*> ANodeSystemManager::FindPath(AInteractiveNode* Start, AInteractiveNode* End) const
+TArray<AInteractiveNode*> ANodeSystemManager::GetNodeHierarchy(AInteractiveNode* RootNode) const
 {
-    TArray<AInteractiveNode*> Path;
-    
-    if (!Start || !End || Start == End)
+    const FNodeHandle RootHandle = GetRegisteredHandle(RootNode);
+    if (!RootHandle.IsValid())
     {
-        return Path;
+        return TArray<AInteractiveNode*>();
     }
 
-    // 简单的BFS路径查找
-    TQueue<AInteractiveNode*> Queue;
-    TMap<AInteractiveNode*, AInteractiveNode*> CameFrom;
-    TSet<AInteractiveNode*> Visited;
-
-    Queue.Enqueue(Start);
-    Visited.Add(Start);
+    // 子树是缓存布局中的连续区间
+    TConstArrayView<int32> Subtree = NodeHierarchy.GetSubtree(RootHandle.Index);
+    if (Subtree.Num() == 0)
+    {
+        return TArray<AInteractiveNode*>({ RootNode });
+    }
 
-    while (!Queue.IsEmpty())
+    TArray<AInteractiveNode*> Hierarchy;
+    Hierarchy.Reserve(Subtree.Num());
+    for (int32 SlotIndex : Subtree)
     {
-        AInteractiveNode* Current;
-        Queue.Dequeue(Current);
+        Hierarchy.Add(NodeSlots[SlotIndex].Node);
+    }
+    return Hierarchy;
+}
 
-        if (Current == End)
-        {
-            // 重建路径
-            AInteractiveNode* Node = End;
-            while (Node != Start)
-            {
-                Path.Insert(Node, 0);
-                Node = CameFrom[Node];
-            }
-            Path.Insert(Start, 0);
-            break;
-        }
+AInteractiveNode* ANodeSystemManager::GetHierarchyParent(AInteractiveNode* Node) const
+{
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    const int32 ParentSlot = Handle.IsValid() ? NodeHierarchy.GetParent(Handle.Index) : INDEX_NONE;
+    return ParentSlot != INDEX_NONE ? NodeSlots[ParentSlot].Node : nullptr;
+}
 
-        // 获取所有连接的节点
-        TArray<ANodeConnection*> Connections = GetConnectionsForNode(Current->GetNodeID());
-        for (ANodeConnection* Connection : Connections)
-        {
-            if (!Connection)
-            {
-                continue;
-            }
+TArray<AInteractiveNode*> ANodeSystemManager::GetHierarchyChildren(AInteractiveNode* Node) const
+{
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    return Handle.IsValid() ? GetNodesFromSlots(TArray<int32>(NodeHierarchy.GetChildren(Handle.Index))) : TArray<AInteractiveNode*>();
+}
 
-            AInteractiveNode* Neighbor = Connection->GetOppositeNode(Current);
-            if (Neighbor && !Visited.Contains(Neighbor))
-            {
-                Visited.Add(Neighbor);
-                CameFrom.Add(Neighbor, Current);
-                Queue.Enqueue(Neighbor);
-            }
-        }
+TArray<AInteractiveNode*> ANodeSystemManager::GetHierarchyAncestors(AInteractiveNode* Node) const
+{
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (!Handle.IsValid())
+    {
+        return TArray<AInteractiveNode*>();
     }
 
-    return Path;
+    TArray<int32> Ancestors;
+    NodeHierarchy.GetAncestors(Handle.Index, Ancestors);
+    return GetNodesFromSlots(Ancestors);
 }
 
-TArray<AInteractiveNode*> ANodeSystemManager::GetNodeHierarchy(AInteractiveNode* RootNode) const
+AInteractiveNode* ANodeSystemManager::GetHierarchyRoot(AInteractiveNode* Node) const
 {
-    TArray<AInteractiveNode*> Hierarchy;
-    
-    if (!RootNode)
-    {
-        return Hierarchy;
-    }
-
-    // // DFS遍历
-    // TSet<AInteractiveNode*> Visited;
-    // TArray<AInteractiveNode*> Stack;
-    //
-    // Stack.Add(RootNode);
-    //
-    // while (Stack.Num() > 0)
-    // {
-    //     AInteractiveNode* Current = Stack.Pop();
-    //     
-    //     if (Visited.Contains(Current))
-    //     {
-    //         continue;
-    //     }
-    //     
-    //     Visited.Add(Current);
-    //     Hierarchy.Add(Current);
-    //     
-    //     // 如果是场景节点，添加其子节点
-    //     if (ASceneNode* SceneNode = Cast<ASceneNode>(Current))
-    //     {
-    //         TArray<AInteractiveNode*> Children = SceneNode->GetAllChildNodes();
-    //         for (int32 i = Children.Num() - 1; i >= 0; i--)
-    //         {
-    //             if (Children[i] && !Visited.Contains(Children[i]))
-    //             {
-    //                 Stack.Add(Children[i]);
-    //             }
-    //         }
-    //     }
-    //     
-    //     // 添加连接的节点
-    //     TArray<ANodeConnection*> Connections = GetOutgoingConnections(Current->GetNodeID());
-    //     for (ANodeConnection* Connection : Connections)
-    //     {
-    //         if (Connection && Connection->GetTargetNode() && !Visited.Contains(Connection->GetTargetNode()))
-    //         {
-    //             Stack.Add(Connection->GetTargetNode());
-    //         }
-    //     }
-    // }
-    
-    return Hierarchy;
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    return Handle.IsValid() ? NodeSlots[NodeHierarchy.GetRoot(Handle.Index)].Node : nullptr;
+}
+
+bool ANodeSystemManager::IsHierarchyAncestor(AInteractiveNode* Ancestor, AInteractiveNode* Node) const
+{
+    const FNodeHandle AncestorHandle = GetRegisteredHandle(Ancestor);
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    return AncestorHandle.IsValid() && Handle.IsValid() && NodeHierarchy.IsAncestorOf(AncestorHandle.Index, Handle.Index);
+}
+
+void ANodeSystemManager::UpdateNodeHierarchy(AInteractiveNode* Node)
+{
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (!Handle.IsValid())
+    {
+        return;
+    }
+
+    // 未注册的场景不参与层级
+    const FNodeHandle SceneHandle = GetRegisteredHandle(Node->GetOwningScene());
+    NodeHierarchy.SetSceneParent(Handle.Index, SceneHandle.IsValid() ? SceneHandle.Index : INDEX_NONE);
 }
 
 // 系统管理实现
@@ -1141,24 +2484,21 @@ bool ANodeSystemManager::SaveSystemState(const FString& SaveName)
     SaveData.ActiveSceneID = ActiveSceneNode ? ActiveSceneNode->GetNodeID() : "";
 
     // 保存节点数据
-    for (const auto& Pair : NodeRegistry)
+    for (const FNodeSlot& Slot : NodeSlots)
     {
-        if (Pair.Value)
+        if (Slot.Node)
         {
-            SaveData.SavedNodes.Add(Pair.Value->GetNodeData());
+            SaveData.SavedNodes.Add(Slot.Node->GetNodeDataRef());
         }
     }
 
-    // 保存连接数据
-    TSet<ANodeConnection*> ProcessedConnections;
-    for (const auto& Pair : ConnectionRegistry)
+    // 保存连接数据（每条连接同时挂在两端槽位上，只在源节点槽位处保存一次）
+    for (const FNodeSlot& Slot : NodeSlots)
     {
-        for (ANodeConnection* Connection : Pair.Value)
+        for (ANodeConnection* Connection : Slot.Connections)
         {
-            if (Connection && !ProcessedConnections.Contains(Connection))
+            if (Connection && Connection->GetSourceNode() == Slot.Node && Connection->GetTargetNode())
             {
-                ProcessedConnections.Add(Connection);
-                
                 FNodeRelationData RelationData;
                 RelationData.SourceNodeID = Connection->GetSourceNode()->GetNodeID();
                 RelationData.TargetNodeID = Connection->GetTargetNode()->GetNodeID();
@@ -1189,91 +2529,231 @@ bool ANodeSystemManager::LoadSystemState(const FString& SaveName)
 void ANodeSystemManager::ResetSystem()
 {
     // 清理所有连接
-    TArray<ANodeConnection*> AllConnections = ActiveConnections;
-    for (ANodeConnection* Connection : AllConnections)
+    RemoveConnections(TArray<ANodeConnection*>(ActiveConnections));
+
+    // 清理所有节点
+    TArray<AInteractiveNode*> AllNodes = GetAllNodes();
+    for (AInteractiveNode* Node : AllNodes)
     {
-        RemoveConnection(Connection);
+        UnregisterNode(Node);
     }
 
-    // 清理所有节点
-    TArray<FString> NodeIDs;
-    NodeRegistry.GetKeys(NodeIDs);
-    for (const FString& NodeID : NodeIDs)
+    // 清空注册表
+    NodeSlots.Empty();
+    FreeNodeSlots.Empty();
+    NodeIDTable.Empty();
+    ConnectionEdgeIndex.Empty();
+    NodeHierarchy.Reset();
+    AdjacencySnapshot.Reset();
+    RelationAnalysis.Reset();
+    StatePropagator.Reset();
+    NodeComponents.Reset();
+    NodeSignificance.Reset();
+    MarkGraphDirty();
+    NodeTypeMap.Empty();
+    NodeTagMap.Empty();
+    NodeTagIndex.Reset();
+    NodeSpatialIndex.Reset();
+    for (FNodeStateBucket& Bucket : StateBuckets)
+    {
+        Bucket.Nodes.Empty();
+    }
+    ActiveConnections.Empty();
+
+    // 重置状态
+    ActiveSceneNode = nullptr;
+    bIsTransitioning = false;
+
+    // 清空队列
+    ClearGenerationQueues();
+
+    OnSystemStateChanged.Broadcast(TEXT("System reset"));
+}
+
+bool ANodeSystemManager::ValidateSystem()
+{
+    bool bIsValid = true;
+    int32 InvalidNodes = 0;
+    int32 InvalidConnections = 0;
+
+    // 验证节点（已被销毁但仍占用槽位的节点）
+    for (const FNodeSlot& Slot : NodeSlots)
+    {
+        if (!Slot.NodeID.IsEmpty() && !IsValid(Slot.Node))
+        {
+            InvalidNodes++;
+            bIsValid = false;
+        }
+    }
+
+    // 验证连接：各分量互不相交，按分量并行扫描，移除在游戏线程上统一提交
+    TArray<TArray<ANodeConnection*>> InvalidPerComponent;
+    InvalidPerComponent.SetNum(GetNodeComponents().GetNumPartitions());
+    ParallelForEachComponent([this, &InvalidPerComponent](int32 Component, TConstArrayView<int32> Slots)
+    {
+        TArray<ANodeConnection*>& Invalid = InvalidPerComponent[Component];
+        for (int32 SlotIndex : Slots)
+        {
+            for (ANodeConnection* Connection : NodeSlots[SlotIndex].Connections)
+            {
+                if (!IsValid(Connection) || !Connection->IsValid())
+                {
+                    Invalid.AddUnique(Connection);
+                }
+            }
+        }
+    });
+
+    TArray<ANodeConnection*> InvalidConnectionsList;
+    for (const TArray<ANodeConnection*>& Invalid : InvalidPerComponent)
+    {
+        InvalidConnectionsList.Append(Invalid);
+    }
+    InvalidConnections = InvalidConnectionsList.Num();
+    bIsValid &= InvalidConnections == 0;
+
+    // 移除无效连接
+    RemoveConnections(InvalidConnectionsList);
+
+    if (!bIsValid)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Validation found %d invalid nodes and %d invalid connections"), 
+            InvalidNodes, InvalidConnections);
+        CleanupInvalidReferences();
+    }
+
+    return bIsValid;
+}
+
+// 状态传播实现
+bool ANodeSystemManager::RequestNodeState(AInteractiveNode* Node, ENodeState NewState, AInteractiveNode* CauseNode, ANodeConnection* CauseConnection)
+{
+    if (!Node)
+    {
+        return false;
+    }
+
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (!Handle.IsValid())
+    {
+        // 未注册节点不参与传播，直接应用
+        Node->SetNodeState(NewState);
+        return true;
+    }
+
+    FNodeStateChangeRecord Record;
+    Record.Slot = Handle.Index;
+    Record.NewState = NewState;
+    Record.CauseSlot = GetRegisteredHandle(CauseNode).Index;
+    Record.CauseConnection = CauseConnection;
+
+    return StatePropagator.Enqueue(Record, RelationAnalysis.GetUnlockRank(Handle.Index));
+}
+
+int32 ANodeSystemManager::FlushStatePropagation()
+{
+    return DrainStatePropagation(0.0);
+}
+
+int32 ANodeSystemManager::DrainStatePropagation(double BudgetSeconds)
+{
+    // 应用状态会同步广播事件，事件中产生的新请求只入队，不在这里重入
+    if (bIsDrainingStates)
+    {
+        return 0;
+    }
+    TGuardValue<bool> DrainGuard(bIsDrainingStates, true);
+
+    const double EndTime = BudgetSeconds > 0.0 ? FPlatformTime::Seconds() + BudgetSeconds : 0.0;
+    int32 NumApplied = 0;
+
+    FNodeStateChangeRecord Record;
+    while (StatePropagator.Dequeue(Record))
     {
-        UnregisterNodeByID(NodeID);
+        // 只是一次指针读取和比较，直接在游戏线程过滤失效和无变化的记录
+        AInteractiveNode* Node = NodeSlots[Record.Slot].Node;
+        if (IsValid(Node) && Node->GetNodeState() != Record.NewState)
+        {
+            Node->SetNodeState(Record.NewState);
+            ++NumApplied;
+        }
+
+        if (EndTime > 0.0 && FPlatformTime::Seconds() >= EndTime)
+        {
+            break;
+        }
     }
 
-    // 清空注册表
-    NodeRegistry.Empty();
-    ConnectionRegistry.Empty();
-    NodeTypeMap.Empty();
-    NodeTagMap.Empty();
-    ActiveNodes.Empty();
-    ActiveConnections.Empty();
+    // 每次排空调用结束一轮：预算截断时工作表可能一直非空，若只在排空时结束，
+    // 之后各帧中合法的重复切换（如反复完成/激活）会被当作回声丢弃
+    StatePropagator.EndEpoch();
 
-    // 重置状态
-    ActiveSceneNode = nullptr;
-    bIsTransitioning = false;
+    return NumApplied;
+}
 
-    // 清空队列
-    ClearGenerationQueues();
+void ANodeSystemManager::RegisterStateCheck(UStateCapability* Capability)
+{
+    if (!Capability || Capability->StateCheckIndex != INDEX_NONE)
+    {
+        return;
+    }
 
-    OnSystemStateChanged.Broadcast(TEXT("System reset"));
+    Capability->StateCheckIndex = StateCheckCapabilities.Add(Capability);
 }
 
-bool ANodeSystemManager::ValidateSystem()
+void ANodeSystemManager::UnregisterStateCheck(UStateCapability* Capability)
 {
-    bool bIsValid = true;
-    int32 InvalidNodes = 0;
-    int32 InvalidConnections = 0;
+    if (!Capability || !StateCheckCapabilities.IsValidIndex(Capability->StateCheckIndex) ||
+        StateCheckCapabilities[Capability->StateCheckIndex] != Capability)
+    {
+        return;
+    }
 
-    // 验证节点
-    TArray<FString> InvalidNodeIDs;
-    for (const auto& Pair : NodeRegistry)
+    // 与末尾交换删除，并修正被移动能力的下标
+    const int32 Index = Capability->StateCheckIndex;
+    StateCheckCapabilities.RemoveAtSwap(Index);
+    if (StateCheckCapabilities.IsValidIndex(Index) && StateCheckCapabilities[Index])
     {
-        if (!IsValid(Pair.Value))
-        {
-            InvalidNodeIDs.Add(Pair.Key);
-            InvalidNodes++;
-            bIsValid = false;
-        }
+        StateCheckCapabilities[Index]->StateCheckIndex = Index;
     }
+    Capability->StateCheckIndex = INDEX_NONE;
+}
 
-    // 移除无效节点
-    for (const FString& NodeID : InvalidNodeIDs)
+void ANodeSystemManager::EvaluateStateConditions()
+{
+    if (StateCheckCapabilities.Num() == 0)
     {
-        NodeRegistry.Remove(NodeID);
+        return;
     }
 
-    // 验证连接
-    TArray<ANodeConnection*> InvalidConnectionsList;
-    for (const auto& Pair : ConnectionRegistry)
+    // 只收集到期的能力
+    const double WorldTime = GetWorld()->GetTimeSeconds();
+    TArray<UStateCapability*> DueCapabilities;
+    for (UStateCapability* Capability : StateCheckCapabilities)
     {
-        for (ANodeConnection* Connection : Pair.Value)
+        if (IsValid(Capability) && Capability->IsStateCheckDue(WorldTime))
         {
-            if (!IsValid(Connection) || !Connection->IsValid())
-            {
-                InvalidConnectionsList.AddUnique(Connection);
-                InvalidConnections++;
-                bIsValid = false;
-            }
+            DueCapabilities.Add(Capability);
         }
     }
 
-    // 移除无效连接
-    for (ANodeConnection* Connection : InvalidConnectionsList)
+    // CheckStateConditions只读所属节点的状态；到期时间和状态修改都留到提交阶段
+    TArray<bool> ConditionsMet;
+    ConditionsMet.SetNumZeroed(DueCapabilities.Num());
+    ParallelFor(DueCapabilities.Num(), [&DueCapabilities, &ConditionsMet](int32 Index)
     {
-        RemoveConnection(Connection);
-    }
+        ConditionsMet[Index] = DueCapabilities[Index]->CheckStateConditions();
+    }, DueCapabilities.Num() < 64 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 
-    if (!bIsValid)
+    // 提交在游戏线程进行；前面的提交可能注销后面的能力
+    for (int32 Index = 0; Index < DueCapabilities.Num(); ++Index)
     {
-        UE_LOG(LogTemp, Warning, TEXT("NodeSystemManager: Validation found %d invalid nodes and %d invalid connections"), 
-            InvalidNodes, InvalidConnections);
-        CleanupInvalidReferences();
+        UStateCapability* Capability = DueCapabilities[Index];
+        if (IsValid(Capability) && Capability->StateCheckIndex != INDEX_NONE)
+        {
+            Capability->CommitStateCheck(WorldTime, ConditionsMet[Index]);
+        }
     }
-
-    return bIsValid;
 }
 
 // 事件处理实现
@@ -1289,20 +2769,36 @@ void ANodeSystemManager::OnNodeStateChanged(AInteractiveNode* Node, ENodeState O
         *UEnum::GetValueAsString(OldState),
         *UEnum::GetValueAsString(NewState));
 
-    // 更新活动节点列表
-    if (NewState == ENodeState::Active)
+    // 连接颜色可能随状态变化
+    GraphDebugRenderer->MarkGeometryDirty();
+
+    // 在状态桶之间移动（只处理已注册节点）
+    if (Node->StateBucketIndex != INDEX_NONE)
     {
-        ActiveNodes.AddUnique(Node);
+        RemoveFromStateBucket(Node);
+        AddToStateBucket(Node);
     }
-    else
+
+    // 进入或离开完成状态时更新下游节点的前置计数
+    const bool bWasCompleted = OldState == ENodeState::Completed;
+    const bool bIsCompleted = NewState == ENodeState::Completed;
+    if (bWasCompleted != bIsCompleted)
     {
-        ActiveNodes.Remove(Node);
+        UpdateDependentPrerequisites(Node, bIsCompleted);
     }
 
-    // 处理完成状态
-    if (NewState == ENodeState::Completed)
+    // 沿邻接表直接通知相关连接（连接不再各自绑定节点委托）
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (Handle.IsValid())
     {
-        ActivateDependentNodes(Node);
+        const TArray<ANodeConnection*, TInlineAllocator<16>> Connections(GetConnectionsView(Handle));
+        for (ANodeConnection* Connection : Connections)
+        {
+            if (IsValid(Connection))
+            {
+                Connection->NotifyEndpointStateChanged(Node, OldState, NewState);
+            }
+        }
     }
 
     // 传播系统事件
@@ -1325,6 +2821,20 @@ void ANodeSystemManager::OnNodeInteracted(AInteractiveNode* Node, const FInterac
 
     // UE_LOG(LogTemp, Log, TEXT("NodeSystemManager: Node %s interacted"), *Node->GetNodeID());
 
+    // 交互传播可能触发其他节点的交互并改动连接表，先拷贝到栈上
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (Handle.IsValid())
+    {
+        const TArray<ANodeConnection*, TInlineAllocator<16>> Connections(GetConnectionsView(Handle));
+        for (ANodeConnection* Connection : Connections)
+        {
+            if (IsValid(Connection))
+            {
+                Connection->NotifyEndpointInteracted(Node, Data);
+            }
+        }
+    }
+
     // 传播系统事件
     FGameEventData EventData;
     EventData.EventID = FString::Printf(TEXT("NodeInteracted_%s"), *Node->GetNodeID());
@@ -1422,6 +2932,12 @@ void ANodeSystemManager::ProcessConnectionGeneration()
         if (Source && Target)
         {
             CreateConnection(Source, Target, RelationData);
+
+            // 队列中的关系全部建立后分析一次
+            if (ConnectionGenerationQueue.IsEmpty())
+            {
+                AnalyzeRelationGraph();
+            }
         }
         else
         {
@@ -1433,67 +2949,78 @@ void ANodeSystemManager::ProcessConnectionGeneration()
 
 void ANodeSystemManager::UpdateNodeIndices()
 {
-    // 重建类型索引
+    // 重建类型索引、标签索引、状态桶和连接哈希索引，邻接快照随版本号失效
+    MarkGraphDirty();
+    ConnectionEdgeIndex.Reset();
+    NodeHierarchy.Reset();
+    NodeComponents.MarkStale();
     NodeTypeMap.Empty();
-    for (const auto& Pair : NodeRegistry)
+    NodeTagMap.Empty();
+    NodeTagIndex.Reset();
+    NodeSpatialIndex.Reset();
+    for (FNodeStateBucket& Bucket : StateBuckets)
     {
-        if (Pair.Value)
-        {
-            UpdateNodeTypeMap(Pair.Value, true);
-        }
+        Bucket.Nodes.Reset();
+    }
+    for (FNodeSlot& Slot : NodeSlots)
+    {
+        Slot.UnmetPrerequisites = 0;
     }
 
-    // 重建标签索引
-    NodeTagMap.Empty();
-    for (const auto& Pair : NodeRegistry)
+    for (int32 SlotIndex = 0; SlotIndex < NodeSlots.Num(); ++SlotIndex)
     {
-        if (Pair.Value)
+        AInteractiveNode* Node = NodeSlots[SlotIndex].Node;
+        if (Node)
         {
-            UpdateNodeTagMap(Pair.Value, true);
+            UpdateNodeTypeMap(Node, true);
+            UpdateNodeTagMap(Node, true);
+            AddToStateBucket(Node);
+            NodeSpatialIndex.Insert(SlotIndex, Node->GetActorLocation());
+
+            // 每条连接只由其源节点的槽位登记一次
+            const FNodeHandle SourceHandle(SlotIndex, NodeSlots[SlotIndex].Generation);
+            for (ANodeConnection* Connection : NodeSlots[SlotIndex].Connections)
+            {
+                if (IsValid(Connection) && Connection->GetSourceNode() == Node)
+                {
+                    const FNodeHandle TargetHandle = GetRegisteredHandle(Connection->GetTargetNode());
+                    AddToEdgeIndex(Connection, SourceHandle, TargetHandle);
+                    AddPrerequisiteEdge(Connection, TargetHandle);
+                    if (Connection->RelationType == ENodeRelationType::Parent && TargetHandle.IsValid())
+                    {
+                        NodeHierarchy.AddLinkParent(TargetHandle.Index, SlotIndex);
+                    }
+                }
+            }
+
+            UpdateNodeHierarchy(Node);
         }
     }
 }
 
 void ANodeSystemManager::CleanupInvalidReferences()
 {
-    // 清理无效的节点引用
-    TArray<FString> KeysToRemove;
-    for (const auto& Pair : NodeRegistry)
+    for (int32 Index = 0; Index < NodeSlots.Num(); ++Index)
     {
-        if (!IsValid(Pair.Value))
+        FNodeSlot& Slot = NodeSlots[Index];
+        if (Slot.NodeID.IsEmpty())
         {
-            KeysToRemove.Add(Pair.Key);
+            continue;
         }
-    }
 
-    for (const FString& Key : KeysToRemove)
-    {
-        NodeRegistry.Remove(Key);
-    }
-
-    // 清理无效的连接引用
-    TArray<FString> ConnectionKeysToRemove;
-    for (const auto& Pair : ConnectionRegistry)
-    {
-        bool bHasValidConnections = false;
-        for (ANodeConnection* Connection : Pair.Value)
+        // 清理无效的节点引用，释放槽位（旧句柄随代数递增而失效）
+        if (!IsValid(Slot.Node))
         {
-            if (IsValid(Connection))
-            {
-                bHasValidConnections = true;
-                break;
-            }
+            NodeIDTable.Remove(Slot.NodeID);
+            ReleaseNodeSlot(FNodeHandle(Index, Slot.Generation));
+            continue;
         }
 
-        if (!bHasValidConnections)
+        // 清理无效的连接引用
+        Slot.Connections.RemoveAll([](const ANodeConnection* Connection)
         {
-            ConnectionKeysToRemove.Add(Pair.Key);
-        }
-    }
-
-    for (const FString& Key : ConnectionKeysToRemove)
-    {
-        ConnectionRegistry.Remove(Key);
+            return !IsValid(Connection);
+        });
     }
 
     // 更新索引
@@ -1513,55 +3040,98 @@ bool ANodeSystemManager::CheckPrerequisites(AInteractiveNode* Node) const
         return false;
     }
 
-    // 获取所有前置条件连接
-    TArray<ANodeConnection*> Prerequisites = GetIncomingConnections(Node->GetNodeID());
-    
-    for (ANodeConnection* Connection : Prerequisites)
+    // 计数在连接增删和源节点状态变化时增量维护
+    const FNodeSlot* Slot = FindNodeSlot(GetRegisteredHandle(Node));
+    return !Slot || Slot->UnmetPrerequisites == 0;
+}
+
+void ANodeSystemManager::UpdateDependentPrerequisites(AInteractiveNode* SourceNode, bool bSourceCompleted)
+{
+    const FNodeHandle SourceHandle = GetRegisteredHandle(SourceNode);
+    if (!SourceHandle.IsValid())
+    {
+        return;
+    }
+
+    // 解锁只入队，由传播工作表按解锁层级应用，不在遍历中触发状态事件
+    ForEachOutgoingConnection(SourceHandle, [this, SourceNode, bSourceCompleted](ANodeConnection* Connection)
     {
-        if (Connection && Connection->RelationType == ENodeRelationType::Prerequisite)
+        const bool bGating = IsGatingRelation(Connection->RelationType);
+        if (!bGating && Connection->RelationType != ENodeRelationType::Dependency)
         {
-            AInteractiveNode* PrereqNode = Connection->GetSourceNode();
-            if (PrereqNode && PrereqNode->GetNodeState() != ENodeState::Completed)
+            return true;
+        }
+
+        FNodeSlot* TargetSlot = FindNodeSlot(GetRegisteredHandle(Connection->GetTargetNode()));
+        if (!TargetSlot)
+        {
+            return true;
+        }
+
+        // Dependency不计入门控计数，但源节点完成时与原ActivateDependentNodes一样解锁前置已满足的目标
+        if (!bGating)
+        {
+            if (bSourceCompleted && TargetSlot->UnmetPrerequisites == 0 &&
+                TargetSlot->Node->GetNodeState() == ENodeState::Locked)
             {
-                return false;
+                RequestNodeState(TargetSlot->Node, ENodeState::Active, SourceNode, Connection);
             }
+            return true;
         }
-    }
 
-    return true;
+        if (!bSourceCompleted)
+        {
+            TargetSlot->UnmetPrerequisites++;
+        }
+        else if (TargetSlot->UnmetPrerequisites > 0 && --TargetSlot->UnmetPrerequisites == 0 &&
+            TargetSlot->Node->GetNodeState() == ENodeState::Locked)
+        {
+            RequestNodeState(TargetSlot->Node, ENodeState::Active, SourceNode, Connection);
+        }
+        return true;
+    });
+}
+
+bool ANodeSystemManager::IsGatingRelation(ENodeRelationType Type)
+{
+    return Type == ENodeRelationType::Prerequisite;
+}
+
+uint32 ANodeSystemManager::GetGatingRelationMask()
+{
+    return (1u << static_cast<uint32>(ENodeRelationType::Prerequisite)) |
+           (1u << static_cast<uint32>(ENodeRelationType::Dependency)) |
+           (1u << static_cast<uint32>(ENodeRelationType::Sequence));
 }
 
-void ANodeSystemManager::ActivateDependentNodes(AInteractiveNode* CompletedNode)
+void ANodeSystemManager::AddPrerequisiteEdge(ANodeConnection* Connection, const FNodeHandle& TargetHandle)
 {
-    if (!CompletedNode)
+    if (!IsGatingRelation(Connection->RelationType))
     {
         return;
     }
 
-    // 获取所有依赖此节点的连接
-    TArray<ANodeConnection*> DependentConnections = GetOutgoingConnections(CompletedNode->GetNodeID());
+    const AInteractiveNode* SourceNode = Connection->GetSourceNode();
+    FNodeSlot* TargetSlot = FindNodeSlot(TargetHandle);
+    if (TargetSlot && SourceNode && SourceNode->GetNodeState() != ENodeState::Completed)
+    {
+        TargetSlot->UnmetPrerequisites++;
+    }
+}
 
-    for (ANodeConnection* Connection : DependentConnections)
+void ANodeSystemManager::RemovePrerequisiteEdge(ANodeConnection* Connection, const FNodeHandle& TargetHandle)
+{
+    if (!IsGatingRelation(Connection->RelationType))
     {
-        if (!Connection)
-        {
-            continue;
-        }
+        return;
+    }
 
-        // 根据连接类型处理
-        if (Connection->RelationType == ENodeRelationType::Prerequisite ||
-            Connection->RelationType == ENodeRelationType::Dependency)
-        {
-            AInteractiveNode* DependentNode = Connection->GetTargetNode();
-            if (DependentNode && DependentNode->GetNodeState() == ENodeState::Locked)
-            {
-                // 检查是否所有前置条件都满足
-                if (CheckPrerequisites(DependentNode))
-                {
-                    DependentNode->SetNodeState(ENodeState::Active);
-                }
-            }
-        }
+    // 只修正计数，不在移除连接时解锁节点
+    const AInteractiveNode* SourceNode = Connection->GetSourceNode();
+    FNodeSlot* TargetSlot = FindNodeSlot(TargetHandle);
+    if (TargetSlot && SourceNode && SourceNode->GetNodeState() != ENodeState::Completed && TargetSlot->UnmetPrerequisites > 0)
+    {
+        TargetSlot->UnmetPrerequisites--;
     }
 }
 
@@ -1573,9 +3143,11 @@ void ANodeSystemManager::RegisterNodeEvents(AInteractiveNode* Node)
         return;
     }
 
-    Node->OnNodeStateChanged.AddDynamic(this, &ANodeSystemManager::OnNodeStateChanged);
-    Node->OnNodeInteracted.AddDynamic(this, &ANodeSystemManager::OnNodeInteracted);
+    Node->OnNodeStateChangedNative.AddUObject(this, &ANodeSystemManager::OnNodeStateChanged);
+    Node->OnNodeInteractedNative.AddUObject(this, &ANodeSystemManager::OnNodeInteracted);
     Node->OnDestroyed.AddDynamic(this, &ANodeSystemManager::OnNodeDestroyed);
+    Node->OnNodeMoved.AddUObject(this, &ANodeSystemManager::UpdateNodeLocation);
+    Node->OnOwningSceneChanged.AddUObject(this, &ANodeSystemManager::UpdateNodeHierarchy);
 }
 
 void ANodeSystemManager::UnregisterNodeEvents(AInteractiveNode* Node)
@@ -1585,9 +3157,11 @@ void ANodeSystemManager::UnregisterNodeEvents(AInteractiveNode* Node)
         return;
     }
 
-    Node->OnNodeStateChanged.RemoveDynamic(this, &ANodeSystemManager::OnNodeStateChanged);
-    Node->OnNodeInteracted.RemoveDynamic(this, &ANodeSystemManager::OnNodeInteracted);
+    Node->OnNodeStateChangedNative.RemoveAll(this);
+    Node->OnNodeInteractedNative.RemoveAll(this);
     Node->OnDestroyed.RemoveDynamic(this, &ANodeSystemManager::OnNodeDestroyed);
+    Node->OnNodeMoved.RemoveAll(this);
+    Node->OnOwningSceneChanged.RemoveAll(this);
 }
 
 void ANodeSystemManager::RegisterConnectionEvents(ANodeConnection* Connection)
@@ -1617,25 +3191,19 @@ void ANodeSystemManager::UpdateNodeTypeMap(AInteractiveNode* Node, bool bAdd)
         return;
     }
 
-    FString TypeKey = UEnum::GetValueAsString(Node->GetNodeData().NodeType);
+    const ENodeType TypeKey = Node->NodeData.NodeType;
 
+    // 节点只在注册时加入一次，无需AddUnique
     if (bAdd)
     {
-        if (!NodeTypeMap.Contains(TypeKey))
-        {
-            NodeTypeMap.Add(TypeKey, TArray<AInteractiveNode*>());
-        }
-        NodeTypeMap[TypeKey].AddUnique(Node);
+        NodeTypeMap.FindOrAdd(TypeKey).Add(Node);
     }
-    else
+    else if (TArray<AInteractiveNode*>* Nodes = NodeTypeMap.Find(TypeKey))
     {
-        if (NodeTypeMap.Contains(TypeKey))
+        Nodes->RemoveSwap(Node);
+        if (Nodes->Num() == 0)
         {
-            NodeTypeMap[TypeKey].Remove(Node);
-            if (NodeTypeMap[TypeKey].Num() == 0)
-            {
-                NodeTypeMap.Remove(TypeKey);
-            }
+            NodeTypeMap.Remove(TypeKey);
         }
     }
 }
@@ -1647,34 +3215,152 @@ void ANodeSystemManager::UpdateNodeTagMap(AInteractiveNode* Node, bool bAdd)
         return;
     }
 
-    FGameplayTagContainer NodeTags = Node->GetNodeData().NodeTags;
-    
-    for (const FGameplayTag& Tag : NodeTags)
+    // 位集索引按槽位索引维护，需要节点已持有有效句柄
+    const FNodeHandle Handle = GetRegisteredHandle(Node);
+    if (Handle.IsValid())
     {
-        FString TagString = Tag.ToString();
-        
         if (bAdd)
         {
-            if (!NodeTagMap.Contains(TagString))
-            {
-                NodeTagMap.Add(TagString, TArray<AInteractiveNode*>());
-            }
-            NodeTagMap[TagString].AddUnique(Node);
+            NodeTagIndex.AddNode(Handle.Index, Node->NodeData.NodeTags);
         }
         else
         {
-            if (NodeTagMap.Contains(TagString))
+            NodeTagIndex.RemoveNode(Handle.Index);
+        }
+    }
+
+    for (const FGameplayTag& Tag : Node->NodeData.NodeTags)
+    {
+        if (bAdd)
+        {
+            NodeTagMap.FindOrAdd(Tag).Add(Node);
+        }
+        else if (TArray<AInteractiveNode*>* Nodes = NodeTagMap.Find(Tag))
+        {
+            Nodes->RemoveSwap(Node);
+            if (Nodes->Num() == 0)
             {
-                NodeTagMap[TagString].Remove(Node);
-                if (NodeTagMap[TagString].Num() == 0)
-                {
-                    NodeTagMap.Remove(TagString);
-                }
+                NodeTagMap.Remove(Tag);
             }
         }
     }
 }
 
+void ANodeSystemManager::AddToEdgeIndex(ANodeConnection* Connection, const FNodeHandle& Source, const FNodeHandle& Target)
+{
+    if (Connection && Source.IsValid() && Target.IsValid())
+    {
+        ConnectionEdgeIndex.Add(FNodeEdgeKey(Source, Target, Connection->RelationType), Connection);
+    }
+}
+
+void ANodeSystemManager::DetachConnectionIndices(ANodeConnection* Connection)
+{
+    Connection->bRemovedFromSystem = true;
+    ConnectionRenderer->RemoveConnection(Connection);
+    Connection->bTransformDirty = false;
+    RemoveFromEdgeIndex(Connection);
+    RemovePrerequisiteEdge(Connection, GetRegisteredHandle(Connection->GetTargetNode()));
+
+    if (Connection->RelationType == ENodeRelationType::Parent)
+    {
+        const FNodeHandle ParentHandle = GetRegisteredHandle(Connection->GetSourceNode());
+        const FNodeHandle ChildHandle = GetRegisteredHandle(Connection->GetTargetNode());
+        if (ParentHandle.IsValid() && ChildHandle.IsValid())
+        {
+            NodeHierarchy.RemoveLinkParent(ChildHandle.Index, ParentHandle.Index);
+        }
+    }
+}
+
+void ANodeSystemManager::QueueConnectionDestroy(ANodeConnection* Connection)
+{
+    if (!IsValid(Connection))
+    {
+        return;
+    }
+
+    // 立即隐藏并停止更新，销毁留到之后的帧
+    Connection->SetActorHiddenInGame(true);
+    Connection->SetActorTickEnabled(false);
+    PendingConnectionDestroys.Add(Connection);
+}
+
+void ANodeSystemManager::ProcessPendingConnectionDestroys(int32 MaxCount)
+{
+    const int32 NumToDestroy = MaxCount > 0 ? FMath::Min(MaxCount, PendingConnectionDestroys.Num()) : PendingConnectionDestroys.Num();
+    for (int32 Index = 0; Index < NumToDestroy; ++Index)
+    {
+        // 连接之间没有顺序要求，从尾部取出
+        ANodeConnection* Connection = PendingConnectionDestroys.Pop(false);
+        if (IsValid(Connection))
+        {
+            Connection->Destroy();
+        }
+    }
+}
+
+void ANodeSystemManager::RemoveFromEdgeIndex(ANodeConnection* Connection)
+{
+    const FNodeEdgeKey Key(
+        GetRegisteredHandle(Connection->GetSourceNode()),
+        GetRegisteredHandle(Connection->GetTargetNode()),
+        Connection->RelationType);
+
+    if (ConnectionEdgeIndex.FindRef(Key) == Connection)
+    {
+        ConnectionEdgeIndex.Remove(Key);
+        return;
+    }
+
+    // RelationType可在蓝图中修改，键对不上时按值查找
+    for (auto It = ConnectionEdgeIndex.CreateIterator(); It; ++It)
+    {
+        if (It.Value() == Connection)
+        {
+            It.RemoveCurrent();
+            return;
+        }
+    }
+}
+
+void ANodeSystemManager::AddToStateBucket(AInteractiveNode* Node)
+{
+    const int32 BucketIndex = static_cast<int32>(Node->GetNodeState());
+    if (!StateBuckets.IsValidIndex(BucketIndex))
+    {
+        return;
+    }
+
+    Node->StateBucket = Node->GetNodeState();
+    Node->StateBucketIndex = StateBuckets[BucketIndex].Nodes.Add(Node);
+}
+
+void ANodeSystemManager::RemoveFromStateBucket(AInteractiveNode* Node)
+{
+    const int32 BucketIndex = static_cast<int32>(Node->StateBucket);
+    const int32 Index = Node->StateBucketIndex;
+    if (!StateBuckets.IsValidIndex(BucketIndex))
+    {
+        return;
+    }
+
+    TArray<AInteractiveNode*>& Bucket = StateBuckets[BucketIndex].Nodes;
+    if (!Bucket.IsValidIndex(Index) || Bucket[Index] != Node)
+    {
+        return;
+    }
+
+    // 用桶尾元素填补空位，并修正它记录的下标
+    Bucket.RemoveAtSwap(Index, 1, false);
+    if (Bucket.IsValidIndex(Index))
+    {
+        Bucket[Index]->StateBucketIndex = Index;
+    }
+
+    Node->StateBucketIndex = INDEX_NONE;
+}
+
 FVector ANodeSystemManager::CalculateNodeSpawnLocation(const FVector& BaseLocation) const
 {
     // 在基础位置周围随机生成
@@ -1687,3 +3373,76 @@ FVector ANodeSystemManager::CalculateNodeSpawnLocation(const FVector& BaseLocati
     
     return FVector(X, Y, Z);
 }
+
+FNodeHandle ANodeSystemManager::AllocateNodeSlot(AInteractiveNode* Node, const FString& NodeID)
+{
+    int32 Index;
+    if (FreeNodeSlots.Num() > 0)
+    {
+        Index = FreeNodeSlots.Pop(false);
+    }
+    else
+    {
+        Index = NodeSlots.AddDefaulted();
+    }
+
+    FNodeSlot& Slot = NodeSlots[Index];
+    Slot.Node = Node;
+    Slot.NodeID = NodeID;
+    Slot.Connections.Reset();
+    Slot.UnmetPrerequisites = 0;
+
+    return FNodeHandle(Index, Slot.Generation);
+}
+
+void ANodeSystemManager::ReleaseNodeSlot(const FNodeHandle& Handle)
+{
+    if (!NodeSlots.IsValidIndex(Handle.Index) || NodeSlots[Handle.Index].Generation != Handle.Generation)
+    {
+        return;
+    }
+
+    FNodeSlot& Slot = NodeSlots[Handle.Index];
+    Slot.Node = nullptr;
+    Slot.NodeID.Empty();
+    Slot.Connections.Empty();
+    Slot.UnmetPrerequisites = 0;
+
+    // 递增代数使所有旧句柄失效
+    ++Slot.Generation;
+    FreeNodeSlots.Add(Handle.Index);
+}
+
+FNodeSlot* ANodeSystemManager::FindNodeSlot(const FNodeHandle& Handle)
+{
+    if (!NodeSlots.IsValidIndex(Handle.Index))
+    {
+        return nullptr;
+    }
+
+    FNodeSlot& Slot = NodeSlots[Handle.Index];
+    return (Slot.Node && Slot.Generation == Handle.Generation) ? &Slot : nullptr;
+}
+
+const FNodeSlot* ANodeSystemManager::FindNodeSlot(const FNodeHandle& Handle) const
+{
+    if (!NodeSlots.IsValidIndex(Handle.Index))
+    {
+        return nullptr;
+    }
+
+    const FNodeSlot& Slot = NodeSlots[Handle.Index];
+    return (Slot.Node && Slot.Generation == Handle.Generation) ? &Slot : nullptr;
+}
+
+FNodeHandle ANodeSystemManager::GetRegisteredHandle(const AInteractiveNode* Node) const
+{
+    if (!Node)
+    {
+        return FNodeHandle();
+    }
+
+    // 节点上缓存的句柄必须仍指向该节点本身
+    const FNodeSlot* Slot = FindNodeSlot(Node->NodeHandle);
+    return (Slot && Slot->Node == Node) ? Node->NodeHandle : FNodeHandle();
+}
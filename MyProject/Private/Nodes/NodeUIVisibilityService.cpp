@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeUIVisibilityService.cpp
+#include "Nodes/NodeUIVisibilityService.h"
+#include "Nodes/NodeSystemManager.h"
+#include "Nodes/InteractiveNode.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+UNodeUIVisibilityService::UNodeUIVisibilityService()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+
+    BudgetMs = 0.25f;
+    MinSweepInterval = 0.1f;
+    SweepCursor = 0;
+    LastSweepTime = -DBL_MAX;
+    QueryRadius = 0.0f;
+    CandidatesGraphVersion = 0;
+}
+
+void UNodeUIVisibilityService::Update(const ANodeSystemManager& Manager)
+{
+    APlayerController* Player = UGameplayStatics::GetPlayerController(this, 0);
+    const APawn* PlayerPawn = Player ? Player->GetPawn() : nullptr;
+    if (!PlayerPawn)
+    {
+        return;
+    }
+
+    // 上一轮评估完且间隔已到时开始新一轮
+    if (SweepCursor >= SweepHandles.Num())
+    {
+        const double Now = GetWorld()->GetTimeSeconds();
+        if (Now - LastSweepTime < MinSweepInterval)
+        {
+            return;
+        }
+        LastSweepTime = Now;
+        BeginSweep(Manager, PlayerPawn->GetActorLocation());
+    }
+
+    const double EndTime = FPlatformTime::Seconds() + BudgetMs * 0.001;
+    int32 EvaluatedCount = 0;
+    while (SweepCursor < SweepHandles.Num() && (EvaluatedCount == 0 || FPlatformTime::Seconds() < EndTime))
+    {
+        EvaluateNode(Manager, SweepHandles[SweepCursor++], Player);
+        ++EvaluatedCount;
+    }
+}
+
+void UNodeUIVisibilityService::BeginSweep(const ANodeSystemManager& Manager, const FVector& ViewerLocation)
+{
+    if (CandidatesGraphVersion != Manager.GraphVersion)
+    {
+        RefreshCandidates(Manager);
+    }
+
+    SweepHandles.Reset();
+    SweepCursor = 0;
+
+    TArray<int32> NearSlots;
+    Manager.NodeSpatialIndex.QueryRadius(ViewerLocation, QueryRadius, NearSlots);
+    for (int32 SlotIndex : NearSlots)
+    {
+        SweepHandles.Emplace(SlotIndex, Manager.NodeSlots[SlotIndex].Generation);
+    }
+
+    // 已注销或已被其他途径隐藏的节点不再跟踪；与附近节点重复的只会多评估一次，不会重复切换
+    ShownHandles.RemoveAllSwap([&Manager](const FNodeHandle& Handle)
+    {
+        const AInteractiveNode* Node = ResolveNode(Manager, Handle);
+        return !Node || !Node->bUIShown;
+    });
+    SweepHandles.Append(ShownHandles);
+    SweepHandles.Append(AlwaysShownHandles);
+}
+
+void UNodeUIVisibilityService::RefreshCandidates(const ANodeSystemManager& Manager)
+{
+    CandidatesGraphVersion = Manager.GraphVersion;
+    QueryRadius = 0.0f;
+    AlwaysShownHandles.Reset();
+
+    for (int32 SlotIndex = 0; SlotIndex < Manager.NodeSlots.Num(); ++SlotIndex)
+    {
+        const AInteractiveNode* Node = Manager.NodeSlots[SlotIndex].Node;
+        if (!Node)
+        {
+            continue;
+        }
+
+        if (Node->bAlwaysShowUI)
+        {
+            AlwaysShownHandles.Emplace(SlotIndex, Manager.NodeSlots[SlotIndex].Generation);
+        }
+        else
+        {
+            QueryRadius = FMath::Max(QueryRadius, Node->UIDisplayDistance * FMath::Max(Node->UIHideDistanceScale, 1.0f));
+        }
+    }
+}
+
+void UNodeUIVisibilityService::EvaluateNode(const ANodeSystemManager& Manager, const FNodeHandle& Handle, APlayerController* Player)
+{
+    AInteractiveNode* Node = ResolveNode(Manager, Handle);
+    if (!Node)
+    {
+        return;
+    }
+
+    const bool bShouldShow = Node->GetSignificanceTier() == ENodeSignificanceTier::Full && Node->ShouldShowUI(Player);
+    if (bShouldShow == Node->bUIShown)
+    {
+        return;
+    }
+
+    Node->bUIShown = bShouldShow;
+    if (bShouldShow)
+    {
+        ShownHandles.AddUnique(Handle);
+        Node->ShowNodeUI();
+    }
+    else
+    {
+        Node->HideNodeUI();
+    }
+}
+
+AInteractiveNode* UNodeUIVisibilityService::ResolveNode(const ANodeSystemManager& Manager, const FNodeHandle& Handle)
+{
+    if (!Manager.NodeSlots.IsValidIndex(Handle.Index))
+    {
+        return nullptr;
+    }
+
+    const FNodeSlot& Slot = Manager.NodeSlots[Handle.Index];
+    return Slot.Generation == Handle.Generation ? Slot.Node : nullptr;
+}
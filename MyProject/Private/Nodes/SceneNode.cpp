@@ -37,6 +37,9 @@ void ASceneNode::AddChildNode(AInteractiveNode* Node)
 
     ChildNodes.Add(Node);
     RegisterChildNode(Node);
+
+    Node->OwningScene = this;
+    Node->OnOwningSceneChanged.Broadcast(Node);
     
     // 如果场景激活，设置子节点位置
     if (bIsActiveScene)
@@ -60,6 +63,12 @@ void ASceneNode::RemoveChildNode(AInteractiveNode* Node)
 
     UnregisterChildNode(Node);
     ChildNodes.Remove(Node);
+
+    if (Node->OwningScene == this)
+    {
+        Node->OwningScene = nullptr;
+        Node->OnOwningSceneChanged.Broadcast(Node);
+    }
     
     UE_LOG(LogTemp, Log, TEXT("Scene %s removed child node %s"), 
         *NodeData.NodeName, *Node->GetNodeName());
@@ -89,7 +98,7 @@ TArray<AInteractiveNode*> ASceneNode::GetChildNodesByType(ENodeType Type) const
     
     for (AInteractiveNode* Node : ChildNodes)
     {
-        if (Node && Node->GetNodeData().NodeType == Type)
+        if (Node && Node->GetNodeDataRef().NodeType == Type)
         {
             FilteredNodes.Add(Node);
         }
@@ -322,6 +331,7 @@ void ASceneNode::ArrangeChildNodes_Implementation()
             
             FVector NewLocation = SceneCenter + Offset;
             ChildNodes[i]->SetActorLocation(NewLocation);
+            ChildNodes[i]->NotifyNodeMoved();
             
             CurrentAngle += AngleStep;
         }
@@ -401,8 +411,8 @@ void ASceneNode::RegisterChildNode(AInteractiveNode* Node)
     ChildNodeMap.Add(Node->GetNodeID(), Node);
     
     // 订阅子节点事件
-    Node->OnNodeStateChanged.AddDynamic(this, &ASceneNode::OnChildNodeStateChanged);
-    Node->OnNodeInteracted.AddDynamic(this, &ASceneNode::OnChildNodeInteracted);
+    Node->OnNodeStateChangedNative.AddUObject(this, &ASceneNode::OnChildNodeStateChanged);
+    Node->OnNodeInteractedNative.AddUObject(this, &ASceneNode::OnChildNodeInteracted);
     Node->OnNodeStoryTriggered.AddDynamic(this, &ASceneNode::OnChildNodeStoryTriggered);
 }
 
@@ -417,8 +427,8 @@ void ASceneNode::UnregisterChildNode(AInteractiveNode* Node)
     ChildNodeMap.Remove(Node->GetNodeID());
     
     // 取消订阅事件
-    Node->OnNodeStateChanged.RemoveDynamic(this, &ASceneNode::OnChildNodeStateChanged);
-    Node->OnNodeInteracted.RemoveDynamic(this, &ASceneNode::OnChildNodeInteracted);
+    Node->OnNodeStateChangedNative.RemoveAll(this);
+    Node->OnNodeInteractedNative.RemoveAll(this);
     Node->OnNodeStoryTriggered.RemoveDynamic(this, &ASceneNode::OnChildNodeStoryTriggered);
 }
 
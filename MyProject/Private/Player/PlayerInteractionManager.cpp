@@ -631,6 +631,9 @@ void UPlayerInteractionManager::UpdateDragging(AItemNode* Node, const FVector& N
         LastDragLocation = ProjectedLocation;
     }
 
+    // 同步空间索引
+    Node->NotifyNodeMoved();
+
     // 处理拖拽交互
     ProcessInteraction(Node, EInteractionType::Drag, Node->GetActorLocation());
 }
@@ -169,32 +169,31 @@ void AJSONTest::ProcessNodeData(const TArray<FNodeGenerateData>& NodeData, const
 {
     ASceneNode* MainScene = nullptr;
     
-    // 第一步：创建所有节点
+    // 第一步：批量创建所有节点
+    TArray<FNodeGenerateData> ModifiedDataList;
+    ModifiedDataList.Reserve(NodeData.Num());
     for (const FNodeGenerateData& Data : NodeData)
     {
         // 设置正确的节点类
-        FNodeGenerateData ModifiedData = Data;
+        FNodeGenerateData& ModifiedData = ModifiedDataList.Add_GetRef(Data);
         ModifiedData.NodeClass = GetNodeClassForType(Data.NodeData.NodeType);
         
         // 调整生成位置（相对于测试Actor）
         ModifiedData.SpawnTransform.SetLocation(GetActorLocation() + Data.SpawnTransform.GetLocation());
+    }
+    
+    TArray<AInteractiveNode*> NewNodes = NodeSystemManager->CreateNodes(ModifiedDataList);
+    GeneratedNodes.Reserve(GeneratedNodes.Num() + NewNodes.Num());
+    NodeIDMap.Reserve(NodeIDMap.Num() + NewNodes.Num());
+    for (AInteractiveNode* NewNode : NewNodes)
+    {
+        GeneratedNodes.Add(NewNode);
+        NodeIDMap.Add(NewNode->GetNodeID(), NewNode);
         
-        // 创建节点
-        AInteractiveNode* NewNode = NodeSystemManager->CreateNode(ModifiedData.NodeClass, ModifiedData);
-        if (NewNode)
+        // 记录场景节点
+        if (!MainScene && NewNode->IsA<ASceneNode>())
         {
-            GeneratedNodes.Add(NewNode);
-            NodeIDMap.Add(NewNode->GetNodeID(), NewNode);
-            
-            UE_LOG(LogTemp, Log, TEXT("Created node: %s at %s"), 
-                *NewNode->GetNodeName(), 
-                *NewNode->GetActorLocation().ToString());
-            
-            // 记录场景节点
-            if (NewNode->IsA<ASceneNode>() && !MainScene)
-            {
-                MainScene = Cast<ASceneNode>(NewNode);
-            }
+            MainScene = Cast<ASceneNode>(NewNode);
         }
     }
     
@@ -236,6 +235,9 @@ void AJSONTest::ProcessNodeData(const TArray<FNodeGenerateData>& NodeData, const
         }
     }
     
+    // 第四步：检查门控关系中的环并计算解锁顺序
+    NodeSystemManager->AnalyzeRelationGraph();
+
     UE_LOG(LogTemp, Log, TEXT("JSON processing complete: %d nodes, scene: %s"), 
         GeneratedNodes.Num(), 
         MainScene ? *MainScene->GetNodeName() : TEXT("None"));
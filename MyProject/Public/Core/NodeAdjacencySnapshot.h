@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeAdjacencySnapshot.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeDataTypes.h"
+
+class ANodeConnection;
+
+// 邻接方向
+enum class ENodeEdgeDirection : uint8
+{
+    Outgoing,
+    Incoming,
+    Undirected
+};
+
+// 构建快照的输入边（端点为槽位索引）
+struct FNodeAdjacencyEdge
+{
+    int32 Source = INDEX_NONE;
+    int32 Target = INDEX_NONE;
+    ENodeRelationType RelationType = ENodeRelationType::Dependency;
+    ANodeConnection* Connection = nullptr;
+};
+
+// 边区间 [Begin, End)
+struct FNodeEdgeRange
+{
+    int32 Begin = 0;
+    int32 End = 0;
+
+    int32 Num() const { return End - Begin; }
+};
+
+// 压缩邻接表（CSR）
+// - Offsets按 槽位 * 关系类型数 + 关系类型 索引，同一槽位的各关系类型区间首尾相连
+// - Neighbors/Connections与边一一对应
+struct MYPROJECT_API FNodeAdjacencyList
+{
+    TArray<int32> Offsets;
+    TArray<int32> Neighbors;
+    TArray<ANodeConnection*> Connections;
+};
+
+// 整张连接图按槽位索引的只读快照
+// 出边、入边、无向三份邻接表，每份内部按关系类型分段，计数排序一次构建O(V+E)
+struct MYPROJECT_API FNodeAdjacencySnapshot
+{
+public:
+    void Build(int32 InNumSlots, const TArray<FNodeAdjacencyEdge>& Edges);
+    void Reset();
+
+    int32 GetNumSlots() const { return NumSlots; }
+    int32 GetNumEdges() const { return NumEdges; }
+    bool IsValidSlot(int32 SlotIndex) const { return SlotIndex >= 0 && SlotIndex < NumSlots; }
+
+    const FNodeAdjacencyList& GetList(ENodeEdgeDirection Direction) const { return Lists[static_cast<int32>(Direction)]; }
+
+    // 单个关系类型的边区间
+    FNodeEdgeRange GetEdges(int32 SlotIndex, ENodeEdgeDirection Direction, ENodeRelationType RelationType) const;
+
+    // 槽位所有关系类型的边区间
+    FNodeEdgeRange GetAllEdges(int32 SlotIndex, ENodeEdgeDirection Direction) const;
+
+    // RelationMask按关系类型枚举值置位；访问器返回false时停止遍历
+    template <typename FuncType>
+    void ForEachNeighbor(int32 SlotIndex, ENodeEdgeDirection Direction, uint32 RelationMask, FuncType&& Func) const
+    {
+        if (!IsValidSlot(SlotIndex))
+        {
+            return;
+        }
+
+        const FNodeAdjacencyList& List = GetList(Direction);
+        const int32 Base = SlotIndex * NumRelationTypes;
+        for (int32 Type = 0; Type < NumRelationTypes; ++Type)
+        {
+            if (!(RelationMask & (1u << Type)))
+            {
+                continue;
+            }
+            for (int32 Edge = List.Offsets[Base + Type]; Edge < List.Offsets[Base + Type + 1]; ++Edge)
+            {
+                if (!Func(List.Neighbors[Edge], List.Connections[Edge]))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    static int32 GetNumRelationTypes();
+    static uint32 GetAllRelationsMask() { return (1u << GetNumRelationTypes()) - 1; }
+
+    // 构建时对应的图版本号，由NodeSystemManager比对决定是否重建
+    uint32 BuiltVersion = 0;
+
+private:
+    void BuildList(FNodeAdjacencyList& List, const TArray<FNodeAdjacencyEdge>& Edges, ENodeEdgeDirection Direction);
+
+    FNodeAdjacencyList Lists[3];
+    int32 NumSlots = 0;
+    int32 NumEdges = 0;
+    int32 NumRelationTypes = 0;
+};
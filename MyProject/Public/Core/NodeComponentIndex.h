@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeComponentIndex.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeAdjacencySnapshot.h"
+
+// 关系图的连通分量（按槽位索引，忽略连接方向和关系类型）
+// - 并查集：新增节点/连接时增量合并（路径减半 + 按大小合并）
+// - 并查集无法撤销合并，移除节点/连接时只标记过期，由调用方在下一次查询前按邻接快照重算
+// - 分区（分量 -> 槽位列表）按需生成，缓存到下一次修改
+struct MYPROJECT_API FNodeComponentIndex
+{
+public:
+    void AddSlot(int32 SlotIndex);
+    void Union(int32 SlotA, int32 SlotB);
+
+    void MarkStale() { bStale = true; }
+    bool IsStale() const { return bStale; }
+
+    // 以快照的出边重新合并，只包含IsSlotUsed为真的槽位
+    void Rebuild(const FNodeAdjacencySnapshot& Graph, TFunctionRef<bool(int32)> IsSlotUsed);
+    void Reset();
+
+    // 代表元，未登记的槽位返回INDEX_NONE
+    int32 Find(int32 SlotIndex) const;
+    bool IsConnected(int32 SlotA, int32 SlotB) const;
+
+    // 分区下标在下一次修改前稳定
+    int32 GetNumPartitions() const;
+    TConstArrayView<int32> GetPartition(int32 PartitionIndex) const;
+    int32 GetPartitionOfSlot(int32 SlotIndex) const;
+
+private:
+    void BuildPartitions() const;
+
+    // 路径减半会改写Parent，查询仍为const
+    mutable TArray<int32> Parent;
+    TArray<int32> Size;
+    bool bStale = false;
+
+    mutable TArray<int32> PartitionOffsets;
+    mutable TArray<int32> PartitionSlots;
+    mutable TArray<int32> PartitionOfSlot;
+    mutable bool bPartitionsValid = false;
+};
@@ -88,6 +88,56 @@ enum class EGameEventType : uint8
     SystemEvent     UMETA(DisplayName = "System Event")      // 系统事件
 };
 
+// 节点句柄（槽位索引 + 代数），由NodeSystemManager在注册时分配
+// 槽位被释放后代数递增，旧句柄随之失效
+USTRUCT(BlueprintType)
+struct FNodeHandle
+{
+    GENERATED_BODY()
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Node Handle")
+    int32 Index;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Node Handle")
+    int32 Generation;
+
+    FNodeHandle()
+    {
+        Index = INDEX_NONE;
+        Generation = 0;
+    }
+
+    FNodeHandle(int32 InIndex, int32 InGeneration)
+        : Index(InIndex)
+        , Generation(InGeneration)
+    {
+    }
+
+    // 仅表示句柄已被赋值，是否仍然存活需要向NodeSystemManager查询
+    bool IsValid() const { return Index != INDEX_NONE; }
+
+    void Invalidate()
+    {
+        Index = INDEX_NONE;
+        Generation = 0;
+    }
+
+    bool operator==(const FNodeHandle& Other) const
+    {
+        return Index == Other.Index && Generation == Other.Generation;
+    }
+
+    bool operator!=(const FNodeHandle& Other) const
+    {
+        return !(*this == Other);
+    }
+
+    friend uint32 GetTypeHash(const FNodeHandle& Handle)
+    {
+        return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation));
+    }
+};
+
 // 节点基础数据
 USTRUCT(BlueprintType)
 struct FNodeData
@@ -494,4 +544,191 @@ struct FNodeQueryParams
         MaxDistance = 0.0f; // 0表示不限制距离
         bIncludeInactive = false;
     }
-};
\ No newline at end of file
+};
+
+// 寻路算法
+UENUM(BlueprintType)
+enum class ENodePathAlgorithm : uint8
+{
+    Dijkstra        UMETA(DisplayName = "Dijkstra"),        // 无启发式
+    AStar           UMETA(DisplayName = "A*"),              // 以节点世界坐标距离为启发式
+    Bidirectional   UMETA(DisplayName = "Bidirectional")    // 起点和终点同时搜索
+};
+
+// 寻路方向规则
+UENUM(BlueprintType)
+enum class ENodePathDirection : uint8
+{
+    Directed        UMETA(DisplayName = "Directed"),        // 沿连接方向，双向连接可逆行
+    Reverse         UMETA(DisplayName = "Reverse"),         // 逆连接方向（查询"谁能解锁我"）
+    Undirected      UMETA(DisplayName = "Undirected")       // 忽略方向
+};
+
+// 加权寻路参数
+// 边代价 = (世界距离 * DistanceCostScale + HopCost) * (bUseConnectionWeight ? 2 - ConnectionWeight : 1)
+// 乘数不小于1，因此距离启发式始终可采纳
+USTRUCT(BlueprintType)
+struct FNodePathQuery
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path")
+    ENodePathAlgorithm Algorithm;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path")
+    ENodePathDirection Direction;
+
+    // 为空表示允许所有关系类型
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path")
+    TArray<ENodeRelationType> RelationTypes;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path", meta = (ClampMin = "0.0"))
+    float DistanceCostScale;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path", meta = (ClampMin = "0.0"))
+    float HopCost;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path")
+    bool bUseConnectionWeight;
+
+    // 超过该代价的路径不再扩展，0表示不限制
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path", meta = (ClampMin = "0.0"))
+    float MaxCost;
+
+    FNodePathQuery()
+    {
+        Algorithm = ENodePathAlgorithm::AStar;
+        Direction = ENodePathDirection::Directed;
+        DistanceCostScale = 1.0f;
+        HopCost = 0.0f;
+        bUseConnectionWeight = true;
+        MaxCost = 0.0f;
+    }
+};
+
+// 加权寻路结果
+USTRUCT(BlueprintType)
+struct FNodePathResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Path")
+    bool bFound;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Path")
+    float TotalCost;
+
+    // 含起点和终点
+    UPROPERTY(BlueprintReadOnly, Category = "Path")
+    TArray<AInteractiveNode*> Nodes;
+
+    // Connections[i]连接Nodes[i]和Nodes[i + 1]
+    UPROPERTY(BlueprintReadOnly, Category = "Path")
+    TArray<ANodeConnection*> Connections;
+
+    // 出队扩展的节点数，用于评估搜索开销
+    UPROPERTY(BlueprintReadOnly, Category = "Path")
+    int32 NodesExpanded;
+
+    FNodePathResult()
+    {
+        bFound = false;
+        TotalCost = 0.0f;
+        NodesExpanded = 0;
+    }
+};
+
+// 门控关系图（Prerequisite/Dependency/Sequence）中发现环时的处理策略
+UENUM(BlueprintType)
+enum class ENodeCyclePolicy : uint8
+{
+    Report          UMETA(DisplayName = "Report"),          // 只报告，保留连接
+    BreakCycles     UMETA(DisplayName = "Break Cycles")     // 移除DFS回边，使图无环
+};
+
+// 增量中的单个状态修改
+USTRUCT(BlueprintType)
+struct FNodeStateDelta
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    FString NodeID;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    ENodeState NewState;
+
+    FNodeStateDelta()
+    {
+        NewState = ENodeState::Inactive;
+    }
+};
+
+// 增量中对单个节点数据的修改
+USTRUCT(BlueprintType)
+struct FNodePropertyDelta
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    FString NodeID;
+
+    // 写入CustomProperties，已存在的键被覆盖
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TMap<FString, FString> SetProperties;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FString> RemovedProperties;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    FGameplayTagContainer AddedTags;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    FGameplayTagContainer RemovedTags;
+};
+
+// 图增量：一次提交的新增/移除节点、新增/移除关系、属性和状态修改
+// 整体校验通过后才应用；关系端点可以引用同一增量中新增的节点
+USTRUCT(BlueprintType)
+struct FNodeGraphDelta
+{
+    GENERATED_BODY()
+
+    // NodeClass为空时按NodeType使用管理器的默认类
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FNodeGenerateData> AddedNodes;
+
+    // 节点的所有连接随之移除
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FString> RemovedNodeIDs;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FNodeRelationData> AddedRelations;
+
+    // 按 (源ID, 目标ID, 关系类型) 匹配，其余字段忽略
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FNodeRelationData> RemovedRelations;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FNodePropertyDelta> PropertyChanges;
+
+    // 经状态传播工作表应用，与其他状态请求一样合并和排序
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Delta")
+    TArray<FNodeStateDelta> StateChanges;
+
+    int32 GetOperationCount() const
+    {
+        return AddedNodes.Num() + RemovedNodeIDs.Num() + AddedRelations.Num() + RemovedRelations.Num()
+            + PropertyChanges.Num() + StateChanges.Num();
+    }
+};
+
+// 节点/连接的显著性层级，由NodeSystemManager按距离、视锥和当前场景分配
+UENUM(BlueprintType)
+enum class ENodeSignificanceTier : uint8
+{
+    Full            UMETA(DisplayName = "Full"),            // 全部开启
+    Reduced         UMETA(DisplayName = "Reduced"),         // 保留网格和碰撞，关闭UI组件、Tick和动画
+    Minimal         UMETA(DisplayName = "Minimal"),         // 只保留网格
+    Dormant         UMETA(DisplayName = "Dormant")          // 全部关闭
+};
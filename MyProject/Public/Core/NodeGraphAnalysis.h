@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeGraphAnalysis.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeAdjacencySnapshot.h"
+
+class ANodeConnection;
+
+// 关系图的强连通分量与拓扑分析（按槽位索引）
+// - 迭代式Tarjan，长链不会耗尽调用栈
+// - 分量按拓扑序排列（前驱在前），分量内槽位连续存放
+// - 解锁层级：没有门控前驱为0，否则为前驱层级的最大值+1；同一环内的节点同层
+struct MYPROJECT_API FNodeGraphAnalysis
+{
+public:
+    // 只沿RelationMask中的出边分析
+    void Analyze(const FNodeAdjacencySnapshot& Graph, uint32 RelationMask);
+    void Reset();
+
+    int32 GetNumComponents() const { return FMath::Max(ComponentOffsets.Num() - 1, 0); }
+    TConstArrayView<int32> GetComponent(int32 ComponentIndex) const;
+    int32 GetComponentOfSlot(int32 SlotIndex) const { return ComponentOfSlot.IsValidIndex(SlotIndex) ? ComponentOfSlot[SlotIndex] : INDEX_NONE; }
+    int32 GetUnlockRank(int32 SlotIndex) const { return UnlockRanks.IsValidIndex(SlotIndex) ? UnlockRanks[SlotIndex] : 0; }
+
+    // 所有槽位的拓扑序
+    TConstArrayView<int32> GetTopologicalOrder() const { return ComponentSlots; }
+
+    // 含环的分量（多于一个节点或有自环）
+    TConstArrayView<int32> GetCyclicComponents() const { return CyclicComponents; }
+
+    // DFS回边，全部移除后图无环
+    TConstArrayView<ANodeConnection*> GetCycleEdges() const { return CycleEdges; }
+
+    // 分析时对应的图版本号
+    uint32 AnalyzedVersion = 0;
+
+private:
+    TArray<int32> ComponentOfSlot;
+    TArray<int32> ComponentOffsets;
+    TArray<int32> ComponentSlots;
+    TArray<int32> UnlockRanks;
+    TArray<int32> CyclicComponents;
+    TArray<ANodeConnection*> CycleEdges;
+};
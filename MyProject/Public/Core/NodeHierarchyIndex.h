@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeHierarchyIndex.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 节点层级索引（按槽位索引）
+// - 父节点来源有两种：场景子节点关系和Parent连接；Parent连接更具体，优先于场景
+// - 父指针和子数组实时维护，祖先查询O(depth)
+// - 每棵树缓存一份先序布局，子树是布局中的连续区间；编辑只丢弃受影响树的布局，查询时惰性重建
+struct MYPROJECT_API FNodeHierarchyIndex
+{
+public:
+    // 父节点来源，INDEX_NONE表示清除
+    void SetSceneParent(int32 SlotIndex, int32 SceneSlot);
+    void AddLinkParent(int32 SlotIndex, int32 ParentSlot);
+    void RemoveLinkParent(int32 SlotIndex, int32 ParentSlot);
+
+    // 移除节点：脱离父节点，子节点改挂到其他候选父节点或成为根
+    // 调用方需先清除以该节点为来源的场景/连接父关系
+    void RemoveNode(int32 SlotIndex);
+    void Reset();
+
+    int32 GetParent(int32 SlotIndex) const { return Entries.IsValidIndex(SlotIndex) ? Entries[SlotIndex].Parent : INDEX_NONE; }
+    TConstArrayView<int32> GetChildren(int32 SlotIndex) const;
+    int32 GetRoot(int32 SlotIndex) const;
+    int32 GetDepth(int32 SlotIndex) const;
+    bool IsAncestorOf(int32 AncestorSlot, int32 SlotIndex) const;
+
+    // 由近到远
+    void GetAncestors(int32 SlotIndex, TArray<int32>& OutAncestors) const;
+
+    // 含自身的先序子树（视图在下一次编辑前有效）
+    TConstArrayView<int32> GetSubtree(int32 SlotIndex) const;
+
+private:
+    struct FEntry
+    {
+        int32 Parent = INDEX_NONE;
+        int32 SceneParent = INDEX_NONE;
+        TArray<int32, TInlineAllocator<1>> LinkParents;
+        TArray<int32> Children;
+
+        // 在所属树布局中的位置，布局存在时有效
+        mutable int32 LayoutBegin = INDEX_NONE;
+        mutable int32 SubtreeSize = 0;
+    };
+
+    FEntry& GetOrAddEntry(int32 SlotIndex);
+
+    // 从候选父节点中选出不成环的一个并挂接
+    void ResolveParent(int32 SlotIndex);
+    void Reparent(int32 SlotIndex, int32 NewParent);
+    void InvalidateTree(int32 SlotIndex);
+    const TArray<int32>& GetLayout(int32 RootSlot) const;
+
+    TArray<FEntry> Entries;
+
+    // 根槽位 -> 整棵树的先序序列
+    mutable TMap<int32, TArray<int32>> Layouts;
+};
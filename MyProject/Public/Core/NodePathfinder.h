@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodePathfinder.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeDataTypes.h"
+#include "Core/NodeAdjacencySnapshot.h"
+
+// 邻接快照上的加权最短路搜索（按槽位索引）
+// - 开放表为二叉堆，过期条目出队时丢弃
+// - 每次查询只按槽位数分配定长数组，不按节点分配
+// - 边代价和启发式由调用方提供，代价<0表示该边不可通行
+struct MYPROJECT_API FNodePathfinder
+{
+public:
+    // bAgainstDirection：该边被从目标端走向源端
+    using FEdgeCostFunc = TFunctionRef<float(int32 From, int32 To, ANodeConnection* Connection, bool bAgainstDirection)>;
+
+    // A*启发式，必须不高估剩余代价
+    using FHeuristicFunc = TFunctionRef<float(int32 SlotIndex)>;
+
+    struct FSettings
+    {
+        ENodePathAlgorithm Algorithm = ENodePathAlgorithm::Dijkstra;
+        uint32 RelationMask = 0;
+
+        // 0表示不限制
+        float MaxCost = 0.0f;
+    };
+
+    struct FResult
+    {
+        bool bFound = false;
+        float TotalCost = 0.0f;
+
+        // 含起点和终点；Connections[i]连接Slots[i]和Slots[i + 1]
+        TArray<int32> Slots;
+        TArray<ANodeConnection*> Connections;
+
+        int32 NodesExpanded = 0;
+    };
+
+    explicit FNodePathfinder(const FNodeAdjacencySnapshot& InGraph);
+
+    bool FindPath(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FHeuristicFunc Heuristic, FResult& OutResult) const;
+
+private:
+    struct FOpenEntry
+    {
+        float Priority;
+        float Cost;
+        int32 Slot;
+
+        bool operator<(const FOpenEntry& Other) const { return Priority < Other.Priority; }
+    };
+
+    // 单个方向的搜索状态
+    struct FSearchState
+    {
+        TArray<float> Cost;
+        TArray<int32> Parent;
+        TArray<ANodeConnection*> ParentConnection;
+        TBitArray<> Closed;
+        TArray<FOpenEntry> Open;
+
+        void Init(int32 NumSlots, int32 Source);
+        float TopPriority() const { return Open.Num() > 0 ? Open.HeapTop().Priority : MAX_flt; }
+    };
+
+    bool FindPathUnidirectional(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FHeuristicFunc Heuristic, FResult& OutResult) const;
+    bool FindPathBidirectional(int32 Start, int32 Goal, const FSettings& Settings, FEdgeCostFunc EdgeCost, FResult& OutResult) const;
+
+    // 遍历可从Slot出发（bBackward时为可到达Slot）的边，Func(另一端槽位, 连接, 是否逆向)
+    template <typename FuncType>
+    void ForEachEdge(int32 Slot, bool bBackward, uint32 RelationMask, FuncType&& Func) const;
+
+    const FNodeAdjacencySnapshot& Graph;
+};
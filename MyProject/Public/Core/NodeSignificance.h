@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeSignificance.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeDataTypes.h"
+
+// 层级距离阈值，超过MinimalDistance为Dormant
+struct FNodeSignificanceSettings
+{
+    float FullDistance = 2000.0f;
+    float ReducedDistance = 5000.0f;
+    float MinimalDistance = 12000.0f;
+
+    // 滞回比例：降级需超过阈值*(1+H)，升级需进入阈值*(1-H)
+    float Hysteresis = 0.1f;
+};
+
+// 一个节点的评估输入
+struct FNodeSignificanceInput
+{
+    float DistanceSquared = 0.0f;
+    bool bInFrustum = true;
+    bool bInActiveScene = true;
+};
+
+// 节点显著性层级表（按槽位索引）
+// - 新槽位默认Full，与未启用LOD时的表现一致
+// - 轮转游标让全部槽位在若干帧内轮流被评估，调用方按时间预算决定每帧推进多少
+struct MYPROJECT_API FNodeSignificanceTracker
+{
+public:
+    // 按距离分级，视锥外最高为Reduced，不在当前场景为Dormant
+    static ENodeSignificanceTier EvaluateTier(const FNodeSignificanceInput& Input, ENodeSignificanceTier CurrentTier, const FNodeSignificanceSettings& Settings);
+
+    ENodeSignificanceTier GetTier(int32 SlotIndex) const { return Tiers.IsValidIndex(SlotIndex) ? Tiers[SlotIndex] : ENodeSignificanceTier::Full; }
+
+    // 返回层级是否变化
+    bool SetTier(int32 SlotIndex, ENodeSignificanceTier Tier);
+
+    void RemoveSlot(int32 SlotIndex);
+    void Reset();
+
+    // 返回下一个要评估的槽位，SlotCount为0时返回INDEX_NONE
+    int32 AdvanceCursor(int32 SlotCount);
+
+private:
+    TArray<ENodeSignificanceTier> Tiers;
+    int32 Cursor = 0;
+};
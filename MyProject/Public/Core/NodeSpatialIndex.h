@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeSpatialIndex.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 节点空间哈希网格
+// - 按槽位索引存储节点位置，查询时不再访问Actor
+// - 每个格子是紧凑数组，条目记录自己在格子中的下标，移动/删除为O(1)交换删除
+// - 位置变化只在跨格子时才搬移条目
+struct MYPROJECT_API FNodeSpatialIndex
+{
+public:
+    FNodeSpatialIndex();
+
+    // 修改格子尺寸会按新尺寸重建网格
+    void SetCellSize(float InCellSize);
+    float GetCellSize() const { return CellSize; }
+
+    void Insert(int32 SlotIndex, const FVector& Location);
+    void Update(int32 SlotIndex, const FVector& Location);
+    void Remove(int32 SlotIndex);
+    void Reset();
+
+    // 批量插入前预留槽位条目
+    void ReserveSlots(int32 NumSlots) { Entries.Reserve(NumSlots); }
+
+    bool Contains(int32 SlotIndex) const { return Entries.IsValidIndex(SlotIndex) && Entries[SlotIndex].CellIndex != INDEX_NONE; }
+    int32 Num() const { return NumEntries; }
+
+    // 调用前需确认Contains(SlotIndex)
+    const FVector& GetLocation(int32 SlotIndex) const { return Entries[SlotIndex].Location; }
+
+    // 查询结果为槽位索引
+    void QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutSlots) const;
+    void QueryBox(const FBox& Box, TArray<int32>& OutSlots) const;
+
+    // 半径查询候选数上限（覆盖格子中的条目数），查询规划使用
+    int32 EstimateRadiusCount(const FVector& Center, float Radius) const;
+
+    // 按距离升序返回最近的Count个节点，MaxRadius<=0表示不限距离
+    void QueryNearest(const FVector& Center, int32 Count, float MaxRadius, TArray<int32>& OutSlots) const;
+
+private:
+    struct FEntry
+    {
+        FVector Location = FVector::ZeroVector;
+        FIntVector Cell = FIntVector::ZeroValue;
+        int32 CellIndex = INDEX_NONE;
+    };
+
+    FIntVector ToCell(const FVector& Location) const;
+    void AddToCell(int32 SlotIndex, const FIntVector& Cell);
+    void RemoveFromCell(int32 SlotIndex);
+
+    // 遍历与包围盒相交的格子；格子范围大于已占用格子数时改为遍历全部格子
+    template <typename FuncType>
+    void ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, FuncType&& Func) const;
+
+    TArray<FEntry> Entries;
+    TMap<FIntVector, TArray<int32>> Cells;
+    int32 NumEntries;
+
+    float CellSize;
+    float InvCellSize;
+};
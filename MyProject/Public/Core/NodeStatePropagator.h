@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeStatePropagator.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/NodeDataTypes.h"
+
+class ANodeConnection;
+
+// 待应用的状态变化（按槽位索引）
+struct FNodeStateChangeRecord
+{
+    int32 Slot = INDEX_NONE;
+    ENodeState NewState = ENodeState::Inactive;
+
+    // 引起变化的节点和连接，外部请求时为空
+    int32 CauseSlot = INDEX_NONE;
+    ANodeConnection* CauseConnection = nullptr;
+};
+
+// 状态传播工作表
+// - 每个槽位最多一条待处理记录，重复请求合并为最新状态
+// - 按优先级（解锁层级）出队，同级按入队顺序
+// - 纪元戳防环：同一轮级联中，一个槽位对同一状态只应用一次；调用方在每次排空调用结束时结束一轮
+struct MYPROJECT_API FNodeStatePropagator
+{
+public:
+    // 返回false表示本轮已应用过该状态，请求被丢弃
+    bool Enqueue(const FNodeStateChangeRecord& Record, int32 Priority);
+
+    // 取出下一条记录并打上本轮纪元戳
+    bool Dequeue(FNodeStateChangeRecord& OutRecord);
+
+    // 丢弃槽位的待处理记录和纪元戳（节点注销时调用，避免槽位复用后误应用）
+    void RemoveSlot(int32 SlotIndex);
+
+    void EndEpoch() { ++Epoch; }
+    void Reset();
+
+    int32 Num() const { return NumPending; }
+    bool IsEmpty() const { return NumPending == 0; }
+    bool IsPending(int32 SlotIndex) const { return Pending.IsValidIndex(SlotIndex) && Pending[SlotIndex].Slot != INDEX_NONE; }
+
+private:
+    struct FQueueEntry
+    {
+        int32 Priority;
+        uint32 Sequence;
+        int32 Slot;
+
+        bool operator<(const FQueueEntry& Other) const
+        {
+            return Priority != Other.Priority ? Priority < Other.Priority : Sequence < Other.Sequence;
+        }
+    };
+
+    // 某槽位在某一轮中已应用过的状态
+    struct FAppliedStamp
+    {
+        uint32 Epoch = 0;
+        uint32 StateMask = 0;
+    };
+
+    void EnsureSlot(int32 SlotIndex);
+
+    // 堆项是否仍对应槽位当前的待处理记录（被丢弃或槽位复用后重新入队的旧项失效）
+    bool IsLiveEntry(const FQueueEntry& Entry) const { return Pending[Entry.Slot].Slot != INDEX_NONE && PendingSequences[Entry.Slot] == Entry.Sequence; }
+
+    TArray<FQueueEntry> Heap;
+    TArray<FNodeStateChangeRecord> Pending;
+
+    // 每个槽位待处理记录对应堆项的序号
+    TArray<uint32> PendingSequences;
+    TArray<FAppliedStamp> Applied;
+    int32 NumPending = 0;
+    uint32 NextSequence = 0;
+    uint32 Epoch = 1;
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeTagIndex.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+// 编译后的标签查询（FGameplayTagQuery展开后的表达式树，只解析一次）
+struct MYPROJECT_API FCompiledNodeTagQuery
+{
+    FGameplayTagQueryExpression Root;
+    bool bMatchAll = true;
+
+    // 表达式树含位集无法表达的类型（如精确匹配）时，逐节点回退到原查询
+    FGameplayTagQuery SourceQuery;
+    bool bRequiresFallback = false;
+
+    FCompiledNodeTagQuery() = default;
+    explicit FCompiledNodeTagQuery(const FGameplayTagQuery& Query);
+};
+
+// 层级GameplayTag位集索引
+// - 标签字典：每个出现过的标签（含其所有父标签）分配一列
+// - 列位集：每列按节点槽位索引存一位，查询时整字按位与/或/非
+// - 节点位集：每个槽位按字典列存一位，用于注销和单节点匹配
+struct MYPROJECT_API FNodeTagIndex
+{
+public:
+    void AddNode(int32 SlotIndex, const FGameplayTagContainer& Tags);
+    void RemoveNode(int32 SlotIndex);
+    void Reset();
+
+    // 批量注册前预留槽位容量，避免列位集逐次扩容
+    void ReserveSlots(int32 NumSlots);
+
+    bool ContainsNode(int32 SlotIndex) const { return LiveSlots.IsValidIndex(SlotIndex) && LiveSlots[SlotIndex]; }
+
+    // 按层级语义（与FGameplayTagContainer::HasTag一致）判断
+    bool NodeHasTag(int32 SlotIndex, const FGameplayTag& Tag) const;
+
+    // 返回按槽位索引的匹配位集
+    TBitArray<> Evaluate(const FCompiledNodeTagQuery& Query) const;
+    bool MatchesNode(const FCompiledNodeTagQuery& Query, int32 SlotIndex) const;
+
+    // 标签的匹配节点数（未知标签为0），用于估算选择性
+    int32 GetTagCount(const FGameplayTag& Tag) const;
+    int32 GetNodeCount() const { return NumLiveNodes; }
+    int32 GetSlotCapacity() const { return SlotCapacity; }
+
+    // 估算查询匹配的节点数上限（查询规划使用）
+    int32 EstimateMatchCount(const FCompiledNodeTagQuery& Query) const;
+
+private:
+    int32 FindOrAddColumn(const FGameplayTag& Tag);
+    const TBitArray<>* FindColumn(const FGameplayTag& Tag) const;
+    void EnsureSlotCapacity(int32 SlotIndex);
+
+    TBitArray<> EvaluateFallback(const FGameplayTagQuery& Query) const;
+    TBitArray<> EvaluateExpr(const FGameplayTagQueryExpression& Expr) const;
+    bool MatchesExpr(const FGameplayTagQueryExpression& Expr, int32 SlotIndex) const;
+    int32 EstimateExpr(const FGameplayTagQueryExpression& Expr) const;
+
+    // 标签字典：标签 -> 列索引
+    TMap<FGameplayTag, int32> TagDictionary;
+
+    // 每列一个按槽位索引的位集，以及列中置位数
+    TArray<TBitArray<>> TagColumns;
+    TArray<int32> TagColumnCounts;
+
+    // 每个槽位一个按列索引的位集
+    TArray<TBitArray<>> NodeTagBits;
+
+    // 每个槽位的原始标签（未展开父标签），供回退查询使用
+    TArray<FGameplayTagContainer> NodeTagContainers;
+
+    // 已加入索引的槽位
+    TBitArray<> LiveSlots;
+    int32 NumLiveNodes = 0;
+
+    // 所有列位集的统一长度
+    int32 SlotCapacity = 0;
+};
@@ -140,5 +140,8 @@ private:
     UPROPERTY()
     ANodeSystemManager* CachedSystemManager;
 
+    // 传送目标节点的缓存句柄，避免每次传送都按字符串查找
+    FNodeHandle TeleportTargetHandle;
+
     TMap<AInteractiveNode*, ANodeConnection*> NodeConnectionMap;
 };
\ No newline at end of file
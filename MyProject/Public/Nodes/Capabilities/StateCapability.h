@@ -112,6 +112,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "State|Conditions")
     void RemoveStateCondition(const FString& Key);  // 移除状态条件
 
+    // 有NodeSystemManager时由其批量驱动自动检查：CheckStateConditions在工作线程只读执行，结果在游戏线程提交
+    bool IsStateCheckDue(double WorldTime) const;
+    void CommitStateCheck(double WorldTime, bool bConditionsMet);
+
     UFUNCTION(BlueprintCallable, Category = "State|Transform")
     void TransformAppearance(int32 FormIndex);      // 改变外观形态
 
@@ -141,7 +145,12 @@ protected:
     UFUNCTION()
     void OnStateCheckTimer();
 
+    // 条件满足时改变TargetNodeStates中的节点状态
+    void ApplyTargetNodeStates();
+
 private:
+    friend class ANodeSystemManager;
+
     UPROPERTY()
     ANodeSystemManager* CachedSystemManager;
 
@@ -152,6 +161,10 @@ private:
     UMaterialInterface* OriginalMaterial;
 
     FTimerHandle StateCheckTimerHandle;
+
+    // 由管理器驱动时下一次检查的世界时间，以及在管理器登记表中的下标（由NodeSystemManager维护）
+    double NextStateCheckTime = 0.0;
+    int32 StateCheckIndex = INDEX_NONE;
     FTimerHandle StateTransitionTimerHandle;
 
     bool bIsTransitioning;
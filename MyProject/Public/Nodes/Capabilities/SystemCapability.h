@@ -230,8 +230,8 @@ protected:
     // 内部辅助方法
     ANodeSystemManager* GetNodeSystemManager() const;
     void UpdateTimeControl(float DeltaTime);
-    bool EvaluateConditionRule(const FString& Rule) const;
     FVector GenerateRandomLocation() const;
+    FNodeGenerateData MakeTemplateGenerateData(const FString& TemplateID, const FVector& Location, int32 BatchIndex) const;
     void CleanupInvalidConnections();
     void ProcessThreatUpdate(const FString& ThreatID, float ThreatLevel);
 
@@ -259,4 +259,36 @@ private:
 
     // 随机数生成器
     FRandomStream RandomStream;
+
+    // 已解析的条件规则：添加条件或开始运行时按规则字符串解析一次，评估时不再做字符串处理
+    enum class EConditionRuleKind : uint8
+    {
+        Invalid,
+        NodeState,      // NodeState:<NodeID>==<State>，目标节点通过句柄解析
+        Probability,    // Probability:<EventID>
+        Constant        // A > B，解析时即求值
+    };
+
+    struct FCompiledConditionRule
+    {
+        FString ConditionID;
+        EConditionRuleKind Kind = EConditionRuleKind::Invalid;
+        FString NodeID;
+        ENodeState RequiredState = ENodeState::Inactive;
+        FNodeHandle NodeHandle;
+        FString EventID;
+        bool bConstantResult = false;
+    };
+
+    static void CompileConditionRule(const FString& Rule, FCompiledConditionRule& OutCondition);
+    bool EvaluateCompiledCondition(FCompiledConditionRule& Condition) const;
+
+    // 解析并登记一条条件；已登记的条件ID覆盖原规则
+    int32 CompileCondition(const FString& ConditionID, const FString& Rule);
+
+    // 按ConditionRules整体重建（开始运行时，以及条件数与ConditionRules不一致时）
+    void RebuildCompiledConditions();
+
+    TArray<FCompiledConditionRule> CompiledConditions;
+    TMap<FName, int32> CompiledConditionIndices;
 };
\ No newline at end of file
@@ -15,10 +15,21 @@
 // 前向声明
 class UUserWidget;
 class APlayerController;
+class ASceneNode;
 
 // 故事触发委托
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNodeStoryTriggered, AInteractiveNode*, Node, const TArray<FString>&, EventIDs);
 
+// 节点移动委托（原生，供空间索引等系统增量更新）
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnNodeMoved, AInteractiveNode*);
+
+// 节点所属场景变化委托（原生，供层级索引增量更新）
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnNodeOwningSceneChanged, AInteractiveNode*);
+
+// 状态变化/交互的原生委托，供C++订阅者使用；同名动态委托只保留给蓝图
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnNodeStateChangedNative, AInteractiveNode*, ENodeState, ENodeState);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnNodeInteractedNative, AInteractiveNode*, const FInteractionData&);
+
 UCLASS(Abstract, Blueprintable)
 class MYPROJECT_API AInteractiveNode : public AActor
 {
@@ -58,6 +69,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node|UI", meta = (ClampMin = "0.0"))
     float UIDisplayDistance;
 
+    // 已显示的UI超出UIDisplayDistance * UIHideDistanceScale后才隐藏，避免在边界来回切换
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node|UI", meta = (ClampMin = "1.0"))
+    float UIHideDistanceScale;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node|UI")
     bool bAlwaysShowUI;
 
@@ -82,6 +97,14 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Node|Events")
     FOnNodeStoryTriggered OnNodeStoryTriggered;
 
+    FOnNodeMoved OnNodeMoved;
+
+    FOnNodeOwningSceneChanged OnOwningSceneChanged;
+
+    // 先于对应的动态委托广播
+    FOnNodeStateChangedNative OnNodeStateChangedNative;
+    FOnNodeInteractedNative OnNodeInteractedNative;
+
 protected:
     virtual void BeginPlay() override;
     virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -109,6 +132,26 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Node|Data")
     FString GetNodeName() const { return NodeData.NodeName; }
 
+    // 原生调用方使用，避免拷贝FString/FNodeData
+    const FString& GetNodeIDRef() const { return NodeData.NodeID; }
+    const FNodeData& GetNodeDataRef() const { return NodeData; }
+
+    // 系统句柄（未注册时为无效句柄）
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Node|Data")
+    FNodeHandle GetNodeHandle() const { return NodeHandle; }
+
+    // 显著性层级，由NodeSystemManager按距离、视锥和当前场景分配；未注册时为Full
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Node|Significance")
+    ENodeSignificanceTier GetSignificanceTier() const { return SignificanceTier; }
+
+    // 移动节点后调用，通知系统更新空间索引
+    UFUNCTION(BlueprintCallable, Category = "Node|Core")
+    void NotifyNodeMoved() { OnNodeMoved.Broadcast(this); }
+
+    // 将该节点作为子节点的场景（由ASceneNode::AddChildNode/RemoveChildNode维护）
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Node|Data")
+    ASceneNode* GetOwningScene() const { return OwningScene; }
+
     // 交互接口
     UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Node|Interaction")
     bool CanInteract(const FInteractionData& Data) const;
@@ -134,6 +177,18 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Node|UI")
     void SetUIVisibility(bool bVisible);
 
+    // 由NodeSystemManager的UI可见性服务在显示状态变化时调用，蓝图可覆盖以播放过渡
+    UFUNCTION(BlueprintNativeEvent, Category = "Node|UI")
+    void ShowNodeUI();
+    virtual void ShowNodeUI_Implementation();
+
+    UFUNCTION(BlueprintNativeEvent, Category = "Node|UI")
+    void HideNodeUI();
+    virtual void HideNodeUI_Implementation();
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Node|UI")
+    bool IsUIShown() const { return bUIShown; }
+
     UFUNCTION(BlueprintCallable, BlueprintNativeEvent, BlueprintPure, Category = "Node|UI")
     FText GetInteractionPrompt() const;
     virtual FText GetInteractionPrompt_Implementation() const;
@@ -188,7 +243,29 @@ protected:
     void CreateNodeUI();
 
 private:
-    // UI更新定时器
-    FTimerHandle UIUpdateTimerHandle;
-    void CheckUIVisibility();
+    friend class ANodeSystemManager;
+    friend class ASceneNode;
+    friend class UNodeUIVisibilityService;
+
+    UPROPERTY(Transient)
+    ASceneNode* OwningScene = nullptr;
+
+    // 由NodeSystemManager在注册/注销时维护
+    FNodeHandle NodeHandle;
+
+    // 节点所在的状态桶及其在桶中的下标，由NodeSystemManager维护
+    ENodeState StateBucket = ENodeState::Inactive;
+    int32 StateBucketIndex = INDEX_NONE;
+
+    // Full：全部开启；Reduced：关闭UI组件和Tick；Minimal：再关闭碰撞；Dormant：再隐藏网格
+    void ApplySignificanceTier(ENodeSignificanceTier Tier);
+    ENodeSignificanceTier SignificanceTier = ENodeSignificanceTier::Full;
+
+    // 离开Full层级时记录的原始开关，回到对应层级时恢复而不是强制开启
+    bool bCollisionEnabledAtFull = true;
+    bool bActorTickEnabledAtFull = true;
+    bool bWidgetTickEnabledAtFull = true;
+
+    // 最近一次ShowNodeUI/HideNodeUI的结果，由UI可见性服务和显著性层级维护
+    bool bUIShown = false;
 };
\ No newline at end of file
@@ -56,6 +56,9 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Item|Capabilities")
     TArray<UItemCapability*> GetAllCapabilities() const { return Capabilities; }
 
+    // 原生调用方使用，不拷贝
+    TConstArrayView<UItemCapability*> GetCapabilitiesView() const { return Capabilities; }
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Item|Capabilities")
     bool HasCapability(TSubclassOf<UItemCapability> CapabilityClass) const;
 
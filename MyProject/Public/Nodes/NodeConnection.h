@@ -12,6 +12,9 @@
 
 // 前向声明
 class AInteractiveNode;
+class ANodeSystemManager;
+class UNodeConnectionRenderer;
+class UMaterialInstanceDynamic;
 class UNiagaraComponent;
 class UUserWidget;
 
@@ -86,13 +89,18 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Properties")
     FGameplayTagContainer ConnectionTags;
 
-    // 视觉组件
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection|Components")
+    // 视觉组件：只在使用Actor表现时创建，实例化渲染的连接为空
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient, Category = "Connection|Components")
     UStaticMeshComponent* ConnectionMesh;
 
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection|Components")
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient, Category = "Connection|Components")
     UWidgetComponent* ConnectionInfoWidget;
 
+    // 需要蓝图自定义表现的连接类设为true：自带网格和信息UI组件，不进入管理器的实例化渲染
+    // 没有管理器的连接总是使用Actor表现
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Connection|Visual")
+    bool bUseActorVisuals;
+
     // 视觉属性
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual")
     FLinearColor BaseColor;
@@ -103,9 +111,18 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual")
     float ConnectionThickness;
 
+    // 激活和脉冲时播放动画；动画数据只在开始时写入一次，由材质按世界时间插值，不需要Tick
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual")
     bool bAnimateConnection;
 
+    // 动画进度每秒增量，1表示一秒完成
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual", meta = (ClampMin = "0.01"))
+    float AnimationSpeed;
+
+    // 脉冲起始颜色，随动画过渡回连接颜色
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual")
+    FLinearColor PulseColor;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Connection|Visual")
     FConnectionVisualData VisualData;
 
@@ -130,6 +147,7 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Connection|Events")
     FOnConnectionDeactivated OnConnectionDeactivated;
 
+    // 脉冲动画播放完毕时广播一次
     UPROPERTY(BlueprintAssignable, Category = "Connection|Events")
     FOnConnectionPulsed OnConnectionPulsed;
 
@@ -150,6 +168,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Connection|Setup")
     void SetBidirectional(bool bBidirectional);
 
+    // 由创建该连接的管理器设置：状态传播经其工作表应用，端点的状态/交互事件由其直接分发，连接不再逐个绑定
+    void SetSystemManager(ANodeSystemManager* InSystemManager) { SystemManager = InSystemManager; }
+
+    // 管理器沿邻接表分发端点事件的入口
+    void NotifyEndpointStateChanged(AInteractiveNode* Node, ENodeState OldState, ENodeState NewState);
+    void NotifyEndpointInteracted(AInteractiveNode* Node, const FInteractionData& Data);
+
     // 查询方法
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Connection|Query")
     bool IsValid() const;
@@ -169,10 +194,27 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Connection|Query")
     AInteractiveNode* GetTargetNode() const { return TargetNode; }
 
+    // 连接网格的世界变换：位于两端连接点中点，X轴指向目标，X缩放按长度100的网格拉伸
+    FTransform GetConnectionTransform() const;
+
+    // Actor表现：写入Actor位置旋转和网格缩放，只触发一次Actor变换传播
+    void ApplyConnectionTransform(const FTransform& ConnectionTransform);
+
+    bool ShouldUseActorVisuals() const { return bUseActorVisuals || SystemManager == nullptr; }
+    bool IsInstancedRendered() const { return InstancedRenderer != nullptr; }
+
+    // 显著性层级，取两端节点中较高的一个，由NodeSystemManager维护
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Connection|Significance")
+    ENodeSignificanceTier GetSignificanceTier() const { return SignificanceTier; }
+
     // 状态管理
     UFUNCTION(BlueprintCallable, Category = "Connection|State")
     void Activate();
 
+    // 播放一次脉冲，动画结束时广播OnConnectionPulsed；低于Full层级时只广播事件
+    UFUNCTION(BlueprintCallable, Category = "Connection|State")
+    void Pulse();
+
     UFUNCTION(BlueprintCallable, Category = "Connection|State")
     void Deactivate();
 
@@ -219,6 +261,12 @@ protected:
 
     void CalculateConnectionPoints(FVector& OutStart, FVector& OutEnd) const;
 
+    // 按需创建Actor表现所需的网格和信息UI组件
+    void CreateActorVisuals();
+
+    // 动画结束后的稳定颜色，动画期间的插值由材质完成
+    FLinearColor GetDisplayColor() const;
+
     // 事件处理
     UFUNCTION()
     void OnSourceNodeStateChanged(AInteractiveNode* Node, ENodeState OldState, ENodeState NewState);
@@ -237,13 +285,62 @@ protected:
     void UnregisterNodeEvents();
     bool ValidateConnection() const;
     void HandleNodeStateChange(AInteractiveNode* ChangedNode, ENodeState NewState);
+    void ApplyPropagatedState(AInteractiveNode* FromNode, AInteractiveNode* ToNode, ENodeState NewState);
 
     UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Connection|Internal")
     void ApplyRelationTypeRules();
     virtual void ApplyRelationTypeRules_Implementation();
 
 private:
-    // 动画相关
-    float CurrentAnimationTime;
+    friend class UNodeConnectionRenderer;
+    friend class ANodeSystemManager;
+
+    UPROPERTY(Transient)
+    ANodeSystemManager* SystemManager;
+
+    // 由UNodeConnectionRenderer维护：所在批次（关系类型）和实例下标
+    UPROPERTY(Transient)
+    UNodeConnectionRenderer* InstancedRenderer;
+
+    int32 RenderBatchIndex;
+    int32 RenderInstanceIndex;
+    bool bInstanceVisible;
+
+    // 端点移动后由管理器置位，已在其脏连接列表中
+    bool bTransformDirty;
+
+    // 管理器摘除该连接时置位；销毁是延迟的，之后的重复移除直接返回
+    bool bRemovedFromSystem;
+
+    // 低于Full时不播放动画，Dormant时隐藏
+    void ApplySignificanceTier(ENodeSignificanceTier Tier);
+    ENodeSignificanceTier SignificanceTier;
+
+    // 离开Full层级时记录的信息组件Tick开关，回到Full时恢复
+    bool bWidgetTickEnabledAtFull;
+
+    // Actor表现：网格原始材质，以及动画或无共享材质可用时的自有材质实例（创建一次后复用）
+    UPROPERTY(Transient)
+    UMaterialInterface* ActorBaseMaterial;
+
+    UPROPERTY(Transient)
+    UMaterialInstanceDynamic* ConnectionMaterialInstance;
+
+    // 最近一次写入自有材质实例的颜色，相同则跳过参数写入
+    FLinearColor AppliedMaterialColor;
+    bool bHasAppliedMaterialColor;
+
+    // 动画相关：从AnimationFromColor开始、于AnimationStartTime（世界时间秒）起按AnimationSpeed过渡到连接颜色
+    // bIsAnimating在激活或脉冲后为true，经过1/AnimationSpeed秒或停用后为false（写入速度0）
+    void StartAnimation(const FLinearColor& FromColor);
+    void FinishAnimation();
+    void BroadcastPulse();
+
+    float AnimationStartTime;
+    FLinearColor AnimationFromColor;
     bool bIsAnimating;
+    FTimerHandle AnimationTimerHandle;
+
+    // 最近一次写入自有材质实例的动画开始时间，相同则跳过动画参数写入
+    float AppliedAnimationStartTime;
 };
\ No newline at end of file
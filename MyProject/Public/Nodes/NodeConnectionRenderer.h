@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeConnectionRenderer.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "Core/NodeDataTypes.h"
+#include "NodeConnectionRenderer.generated.h"
+
+// 前向声明
+class ANodeConnection;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+
+// 连接的实例化渲染器，由NodeSystemManager持有
+// - 每种关系类型一个实例化网格组件，一条连接对应其中一个实例
+// - 每实例自定义数据（材质需读取PerInstanceCustomData）：
+//   0-3 连接颜色RGBA（取自GetConnectionColor）；4-6 动画起始颜色RGB；7 动画开始时间（世界时间秒）；8 动画速度（0为无动画）
+// - 材质以 saturate((Time - 开始时间) * 速度) 为进度从起始颜色过渡到连接颜色，也可与沿X轴的UV比较表现为流动；动画期间没有CPU开销
+// - 移除时与末尾实例交换，实例下标保存在连接上
+UCLASS(ClassGroup = (Nodes), meta = (BlueprintSpawnableComponent))
+class MYPROJECT_API UNodeConnectionRenderer : public USceneComponent
+{
+    GENERATED_BODY()
+
+public:
+    UNodeConnectionRenderer();
+
+    // 沿X轴、长度100的网格，与ANodeConnection的默认网格一致
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rendering")
+    UStaticMesh* ConnectionMesh;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rendering")
+    UMaterialInterface* DefaultMaterial;
+
+    // 未配置的关系类型使用DefaultMaterial
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rendering")
+    TMap<ENodeRelationType, UMaterialInterface*> RelationMaterials;
+
+    static constexpr int32 NumCustomDataFloats = 9;
+
+    void AddConnection(ANodeConnection* Connection);
+    void RemoveConnection(ANodeConnection* Connection);
+    void ClearConnections();
+
+    // 由连接的UpdateConnection/UpdateVisuals调用
+    void UpdateConnectionTransform(ANodeConnection* Connection);
+
+    // 批量写入预先算好的变换（Transforms[i]对应Connections[i]），每个批次只标记一次渲染状态
+    // 不由本渲染器绘制的连接被跳过
+    void ApplyConnectionTransforms(TConstArrayView<ANodeConnection*> Connections, TConstArrayView<FTransform> Transforms);
+
+    // 颜色和动画数据未变时不写自定义数据；可见性变化时改写实例缩放
+    void UpdateConnectionVisuals(ANodeConnection* Connection);
+
+    // 使用Actor表现的静态连接共享的动态材质，按 (基础材质, 关系类型, 是否激活) 缓存，参数只在创建时写入
+    // 同一键下颜色不同（如蓝图改写了GetConnectionColor）时返回nullptr，调用方改用自己的材质实例
+    UMaterialInstanceDynamic* GetSharedMaterial(UMaterialInterface* BaseMaterial, ENodeRelationType RelationType, bool bActive, const FLinearColor& Color);
+
+    // 连接材质的参数名，动画参数只用于Actor表现的自有材质实例
+    static const FName ColorParameterName;
+    static const FName OpacityParameterName;
+    static const FName AnimationColorParameterName;
+    static const FName AnimationStartTimeParameterName;
+    static const FName AnimationSpeedParameterName;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Rendering")
+    int32 GetInstanceCount() const;
+
+private:
+    // 一种关系类型的实例批次
+    struct FConnectionBatch
+    {
+        UInstancedStaticMeshComponent* Mesh = nullptr;
+
+        // 实例下标 -> 连接
+        TArray<ANodeConnection*> Owners;
+    };
+
+    FConnectionBatch& GetOrCreateBatch(ENodeRelationType RelationType);
+
+    static void BuildCustomData(const ANodeConnection* Connection, float (&OutCustomData)[NumCustomDataFloats]);
+    void WriteConnectionCustomData(ANodeConnection* Connection);
+
+    // 隐藏的连接缩放为0，不参与绘制；同时记录实例当前的可见性
+    static FTransform GetInstanceTransform(ANodeConnection* Connection, const FTransform& ConnectionTransform);
+
+    // 按关系类型枚举值索引
+    TArray<FConnectionBatch> Batches;
+
+    // 仅用于保持实例化网格组件的引用
+    UPROPERTY(Transient)
+    TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+    struct FSharedMaterial
+    {
+        UMaterialInstanceDynamic* Material = nullptr;
+        FLinearColor Color;
+    };
+
+    using FSharedMaterialKey = TTuple<UMaterialInterface*, uint8, bool>;
+    TMap<FSharedMaterialKey, FSharedMaterial> SharedMaterials;
+
+    // 仅用于保持共享材质的引用
+    UPROPERTY(Transient)
+    TArray<UMaterialInstanceDynamic*> SharedMaterialRefs;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeGraphDebugRenderer.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ConvexVolume.h"
+#include "Core/NodeDataTypes.h"
+#include "NodeGraphDebugRenderer.generated.h"
+
+// 前向声明
+class ANodeSystemManager;
+class ULineBatchComponent;
+
+// 连接图调试绘制，由NodeSystemManager持有并在Tick中调用
+// - 线段缓存在自有的LineBatchComponent中持续显示，不再每帧逐条DrawDebugLine
+// - 边列表只在图版本变化或节点移动/状态变化后重建；裁剪结果只在视角或设置变化后重新提交
+// - 视锥裁剪 + 距离分级：近处按设定粗细并可显示状态标签，远处画细线，超出最大距离不画
+// - 控制台变量：Node.Debug.DrawGraph / RelationMask / LODDistance / MaxDistance / Thickness / StateLabels
+UCLASS(ClassGroup = (Nodes))
+class MYPROJECT_API UNodeGraphDebugRenderer : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UNodeGraphDebugRenderer();
+
+    // 控制台开启时，无论管理器的bDebugDrawConnections如何都绘制
+    static bool IsEnabledByConsole();
+
+    // 边的端点位置或颜色可能已变化
+    void MarkGeometryDirty() { bGeometryDirty = true; }
+
+    void Update(const ANodeSystemManager& Manager);
+    void Clear();
+
+private:
+    struct FDebugEdge
+    {
+        FVector Start;
+        FVector End;
+        FLinearColor Color;
+        ENodeRelationType RelationType;
+    };
+
+    // 影响裁剪结果的设置和视角，任一变化时重新提交
+    struct FViewState
+    {
+        FVector Location = FVector::ZeroVector;
+        FRotator Rotation = FRotator::ZeroRotator;
+        float FOV = 0.0f;
+        int32 RelationMask = 0;
+        float LODDistance = 0.0f;
+        float MaxDistance = 0.0f;
+        float Thickness = 0.0f;
+
+        bool Equals(const FViewState& Other) const;
+    };
+
+    void RebuildEdges(const ANodeSystemManager& Manager);
+    void SubmitLines(const FConvexVolume& Frustum, const FViewState& View);
+    void DrawStateLabels(const ANodeSystemManager& Manager, const FConvexVolume& Frustum, const FViewState& View) const;
+
+    ULineBatchComponent* GetOrCreateLineBatch();
+
+    UPROPERTY(Transient)
+    ULineBatchComponent* LineBatch;
+
+    TArray<FDebugEdge> Edges;
+    uint32 BuiltGraphVersion;
+    bool bGeometryDirty;
+
+    FViewState SubmittedView;
+    bool bHasSubmitted;
+};
@@ -5,6 +5,14 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Core/NodeDataTypes.h"
+#include "Core/NodeTagIndex.h"
+#include "Core/NodeSpatialIndex.h"
+#include "Core/NodeAdjacencySnapshot.h"
+#include "Core/NodeHierarchyIndex.h"
+#include "Core/NodeGraphAnalysis.h"
+#include "Core/NodeStatePropagator.h"
+#include "Core/NodeComponentIndex.h"
+#include "Core/NodeSignificance.h"
 #include "GameplayTagContainer.h"
 #include "Engine/DataTable.h"
 #include "NodeSystemManager.generated.h"
@@ -15,6 +23,11 @@ class ASceneNode;
 class AItemNode;
 class ANodeConnection;
 class UItemCapability;
+class UStateCapability;
+class UNodeConnectionRenderer;
+class UNodeGraphDebugRenderer;
+class UNodeUIVisibilityService;
+struct FConvexVolume;
 
 // 系统状态结构
 USTRUCT(BlueprintType)
@@ -68,13 +81,171 @@ struct FNodeGenerationResult
     }
 };
 
+// 图增量应用结果
+USTRUCT(BlueprintType)
+struct FNodeGraphDeltaResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    bool bSuccess;
+
+    // 失败时为第一条校验或应用错误，此时系统保持应用前的状态
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    FString ErrorMessage;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    TArray<AInteractiveNode*> CreatedNodes;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    TArray<ANodeConnection*> CreatedConnections;
+
+    // 节点Actor已销毁，只保留ID
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    TArray<FString> RemovedNodeIDs;
+
+    // 含随节点一起移除的连接
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    int32 RemovedConnectionCount;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    int32 ModifiedNodeCount;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Delta")
+    int32 QueuedStateChangeCount;
+
+    FNodeGraphDeltaResult()
+    {
+        bSuccess = false;
+        RemovedConnectionCount = 0;
+        ModifiedNodeCount = 0;
+        QueuedStateChangeCount = 0;
+    }
+};
+
+// 节点槽位（句柄指向的实际存储）
+USTRUCT()
+struct FNodeSlot
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    AInteractiveNode* Node;
+
+    // 注册时驻留的节点ID
+    UPROPERTY()
+    FString NodeID;
+
+    UPROPERTY()
+    int32 Generation;
+
+    // 与该节点相关的所有连接（出边和入边）
+    UPROPERTY()
+    TArray<ANodeConnection*> Connections;
+
+    // 源节点未完成的Prerequisite入边数，为0即可解锁
+    int32 UnmetPrerequisites;
+
+    FNodeSlot()
+    {
+        Node = nullptr;
+        Generation = 0;
+        UnmetPrerequisites = 0;
+    }
+};
+
+// 连接哈希键：(源句柄, 目标句柄, 关系类型)，同一对节点之间可以同时存在多种关系
+struct FNodeEdgeKey
+{
+    FNodeHandle Source;
+    FNodeHandle Target;
+    ENodeRelationType RelationType;
+
+    FNodeEdgeKey(const FNodeHandle& InSource, const FNodeHandle& InTarget, ENodeRelationType InRelationType)
+        : Source(InSource)
+        , Target(InTarget)
+        , RelationType(InRelationType)
+    {
+    }
+
+    bool operator==(const FNodeEdgeKey& Other) const
+    {
+        return Source == Other.Source && Target == Other.Target && RelationType == Other.RelationType;
+    }
+
+    friend uint32 GetTypeHash(const FNodeEdgeKey& Key)
+    {
+        return HashCombine(HashCombine(GetTypeHash(Key.Source), GetTypeHash(Key.Target)), ::GetTypeHash(static_cast<uint8>(Key.RelationType)));
+    }
+};
+
+// 单个状态的节点桶（紧凑数组，节点记录自己在桶中的下标）
+USTRUCT()
+struct FNodeStateBucket
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<AInteractiveNode*> Nodes;
+};
+
+// 查询驱动集合（由查询规划按代价选择）
+enum class ENodeQueryDriver : uint8
+{
+    FullScan,
+    TypeBuckets,
+    StateBuckets,
+    TagIndex,
+    SpatialIndex
+};
+
+// 编译后的节点查询，可缓存复用
+// 过滤条件预先转为位掩码和标签表达式树，执行时再按当前索引规模选择驱动集合
+USTRUCT(BlueprintType)
+struct FCompiledNodeQuery
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Query")
+    FNodeQueryParams Params;
+
+    // 按枚举值置位
+    uint32 TypeMask;
+    uint32 StateMask;
+    bool bHasTypeFilter;
+    bool bHasStateFilter;
+
+    FCompiledNodeTagQuery TagQuery;
+    bool bHasTagQuery;
+
+    float MaxDistanceSq;
+    bool bCompiled;
+
+    FCompiledNodeQuery()
+    {
+        TypeMask = 0;
+        StateMask = 0;
+        bHasTypeFilter = false;
+        bHasStateFilter = false;
+        bHasTagQuery = false;
+        MaxDistanceSq = 0.0f;
+        bCompiled = false;
+    }
+};
+
 // 委托声明
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNodeRegistered, AInteractiveNode*, Node);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNodesRegistered, const TArray<AInteractiveNode*>&, Nodes);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNodeUnregistered, AInteractiveNode*, Node);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNodesUnregistered, const TArray<AInteractiveNode*>&, Nodes);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnConnectionCreated, ANodeConnection*, Connection);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnConnectionsCreated, const TArray<ANodeConnection*>&, Connections);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnConnectionRemoved, ANodeConnection*, Connection);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnConnectionsRemoved, const TArray<ANodeConnection*>&, Connections);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSceneChanged, ASceneNode*, OldScene, ASceneNode*, NewScene);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSystemStateChanged, const FString&, StateDescription);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnRelationCycleDetected, const TArray<AInteractiveNode*>&, CycleNodes);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGraphDeltaApplied, const FNodeGraphDeltaResult&, Result);
 
 UCLASS(Blueprintable)
 class MYPROJECT_API ANodeSystemManager : public AActor
@@ -84,16 +255,52 @@ class MYPROJECT_API ANodeSystemManager : public AActor
 public:
     ANodeSystemManager();
 
-    // 注册表
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|Registry")
-    TMap<FString, AInteractiveNode*> NodeRegistry;
+    // 注册表：槽位数组是节点的主身份，句柄 = (槽位索引, 代数)
+    // 每个槽位同时保存该节点的连接列表
+    UPROPERTY()
+    TArray<FNodeSlot> NodeSlots;
+
+    // 字符串ID到句柄的驻留表，只在注册时写入
+    TMap<FString, FNodeHandle> NodeIDTable;
+
+    // 连接哈希索引，在CreateConnection/RemoveConnection中维护
+    // 连接对象由ActiveConnections持有引用
+    TMap<FNodeEdgeKey, ANodeConnection*> ConnectionEdgeIndex;
 
-    // 使用TArray代替TMultiMap
-    TMap<FString, TArray<ANodeConnection*>> ConnectionRegistry;
+    TMap<ENodeType, TArray<AInteractiveNode*>> NodeTypeMap;
 
-    TMap<FString, TArray<AInteractiveNode*>> NodeTypeMap;
+    TMap<FGameplayTag, TArray<AInteractiveNode*>> NodeTagMap;
 
-    TMap<FString, TArray<AInteractiveNode*>> NodeTagMap;
+    // 层级标签位集索引（按槽位索引），供ExecuteNodeQuery的标签过滤使用
+    FNodeTagIndex NodeTagIndex;
+
+    // 空间哈希网格（按槽位索引），节点移动时增量更新
+    FNodeSpatialIndex NodeSpatialIndex;
+
+    // 层级索引（按槽位索引），统一场景子节点关系和Parent连接
+    FNodeHierarchyIndex NodeHierarchy;
+
+    // 连接图的CSR快照（按槽位索引），图版本号变化后在下一次图查询时惰性重建
+    mutable FNodeAdjacencySnapshot AdjacencySnapshot;
+
+    // 节点注册/注销、连接创建/移除时递增
+    uint32 GraphVersion;
+
+    // 门控关系图的强连通分量和解锁层级，在AnalyzeRelationGraph中计算
+    FNodeGraphAnalysis RelationAnalysis;
+
+    // 状态传播工作表（按槽位索引），在Tick中按预算排空
+    FNodeStatePropagator StatePropagator;
+
+    // 关系图连通分量（按槽位索引），新增时增量合并，移除后在下一次查询时重算
+    mutable FNodeComponentIndex NodeComponents;
+
+    // 节点显著性层级（按槽位索引），在Tick中按预算轮转评估
+    FNodeSignificanceTracker NodeSignificance;
+
+    // 按ENodeState分桶，下标即状态枚举值，在OnNodeStateChanged中增量维护
+    UPROPERTY(Transient)
+    TArray<FNodeStateBucket> StateBuckets;
 
     // 默认类
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Classes")
@@ -105,13 +312,22 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Classes")
     TSubclassOf<ANodeConnection> DefaultConnectionClass;
 
+    // 每种关系类型一个实例化网格，绘制所有未选择Actor表现的连接
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|Components")
+    UNodeConnectionRenderer* ConnectionRenderer;
+
+    // bDebugDrawConnections或控制台变量Node.Debug.DrawGraph开启时绘制连接图
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|Components")
+    UNodeGraphDebugRenderer* GraphDebugRenderer;
+
+    // 按玩家附近的节点分帧判断信息UI是否显示，取代每个节点的定时器
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|Components")
+    UNodeUIVisibilityService* UIVisibilityService;
+
     // 状态
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|State")
     ASceneNode* ActiveSceneNode;
 
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|State")
-    TArray<AInteractiveNode*> ActiveNodes;
-
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "System|State")
     TArray<ANodeConnection*> ActiveConnections;
 
@@ -128,6 +344,53 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config")
     bool bDebugDrawConnections;
 
+    // AnalyzeRelationGraph发现门控环时的处理方式
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config")
+    ENodeCyclePolicy CyclePolicy;
+
+    // 每帧状态传播的时间预算（毫秒），0表示每帧排空
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config", meta = (ClampMin = "0.0"))
+    float PropagationBudgetMs;
+
+    // StateCapability自动条件检查的批量评估间隔（秒），各能力仍按自己的StateCheckInterval判断是否到期
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config", meta = (ClampMin = "0.0"))
+    float ConditionEvaluationInterval;
+
+    // 已移除连接每帧最多销毁的Actor数
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config", meta = (ClampMin = "1"))
+    int32 MaxConnectionDestroysPerFrame;
+
+    // 空间索引格子尺寸，约等于常用查询半径时效果最好
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Config", meta = (ClampMin = "1.0"))
+    float SpatialCellSize;
+
+    // 显著性LOD：按到相机的距离、视锥和当前场景为节点分级，层级决定网格、碰撞、UI组件、Tick和动画是否开启
+    // 连接取两端节点中较高的层级
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance")
+    bool bEnableSignificanceLOD;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0"))
+    float SignificanceFullDistance;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0"))
+    float SignificanceReducedDistance;
+
+    // 超过该距离的节点进入Dormant
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0"))
+    float SignificanceMinimalDistance;
+
+    // 层级切换的滞回比例，避免在阈值附近来回切换
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0", ClampMax = "0.5"))
+    float SignificanceHysteresis;
+
+    // 视锥测试使用的节点包围球半径
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0"))
+    float SignificanceBoundsRadius;
+
+    // 每帧评估的时间预算（毫秒）；相机附近的节点最多用一半，轮转每帧至少评估32个节点
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "System|Significance", meta = (ClampMin = "0.0"))
+    float SignificanceBudgetMs;
+
     // 生成队列
     TQueue<FNodeGenerateData> NodeGenerationQueue;
     TQueue<FNodeRelationData> ConnectionGenerationQueue;
@@ -147,21 +410,45 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnNodeRegistered OnNodeRegistered;
 
+    // 批量注册只广播一次，不再逐个触发OnNodeRegistered
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnNodesRegistered OnNodesRegistered;
+
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnNodeUnregistered OnNodeUnregistered;
 
+    // 图增量中移除的节点只广播一次，不再逐个触发OnNodeUnregistered；广播后节点才被销毁
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnNodesUnregistered OnNodesUnregistered;
+
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnConnectionCreated OnConnectionCreated;
 
+    // 图增量中新增的连接只广播一次，不再逐条触发OnConnectionCreated
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnConnectionsCreated OnConnectionsCreated;
+
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnConnectionRemoved OnConnectionRemoved;
 
+    // 批量移除只广播一次，不再逐条触发OnConnectionRemoved
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnConnectionsRemoved OnConnectionsRemoved;
+
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnSceneChanged OnSceneChanged;
 
     UPROPERTY(BlueprintAssignable, Category = "System|Events")
     FOnSystemStateChanged OnSystemStateChanged;
 
+    // 每个含环的强连通分量广播一次
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnRelationCycleDetected OnRelationCycleDetected;
+
+    // 图增量提交后广播一次，在各类批量事件（OnNodesRegistered/OnConnectionsCreated/OnConnectionsRemoved/OnNodesUnregistered）之后
+    UPROPERTY(BlueprintAssignable, Category = "System|Events")
+    FOnGraphDeltaApplied OnGraphDeltaApplied;
+
     
 
 
@@ -176,6 +463,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "System|Nodes", meta = (DisplayName = "Create Node"))
     AInteractiveNode* CreateNode(TSubclassOf<AInteractiveNode> NodeClass, const FNodeGenerateData& GenerateData);
 
+    // 批量创建：按生成数据中的NodeClass生成，统一注册后再添加能力
+    UFUNCTION(BlueprintCallable, Category = "System|Nodes")
+    TArray<AInteractiveNode*> CreateNodes(const TArray<FNodeGenerateData>& GenerateDataList);
+
     UFUNCTION(BlueprintCallable, Category = "System|Nodes")
     ASceneNode* CreateSceneNode(const FNodeGenerateData& GenerateData);
 
@@ -189,12 +480,21 @@ public:
     UFUNCTION(BlueprintCallable, Category = "System|Nodes")
     bool RegisterNode(AInteractiveNode* Node);
 
+    // 批量注册：预留容量、一次遍历建好索引，返回成功注册的数量
+    UFUNCTION(BlueprintCallable, Category = "System|Nodes")
+    int32 RegisterNodes(const TArray<AInteractiveNode*>& Nodes);
+
     UFUNCTION(BlueprintCallable, Category = "System|Nodes", meta = (DisplayName = "Unregister Node by ID"))
     bool UnregisterNodeByID(const FString& NodeID);
 
     UFUNCTION(BlueprintCallable, Category = "System|Nodes", meta = (DisplayName = "Unregister Node"))
     bool UnregisterNode(AInteractiveNode* Node);
 
+    // 图增量：先按ID索引校验整个增量，通过后一次性应用
+    // 只有新增部分可能在应用中失败（生成Actor失败），此时撤销已新增的节点和连接；移除和修改在新增成功后才执行
+    UFUNCTION(BlueprintCallable, Category = "System|Nodes")
+    FNodeGraphDeltaResult ApplyGraphDelta(const FNodeGraphDelta& Delta);
+
     // 节点查询
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     AInteractiveNode* GetNode(const FString& NodeID) const;
@@ -211,9 +511,53 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AInteractiveNode*> GetNodesInRadius(const FVector& Center, float Radius) const;
 
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> GetNodesInBox(const FBox& Box) const;
+
+    // 按距离升序返回最近的节点，MaxRadius<=0表示不限距离
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> GetNearestNodes(const FVector& Center, int32 Count, float MaxRadius = 0.0f) const;
+
+    // 同步节点在空间索引中的位置（节点的OnNodeMoved会自动调用）
+    UFUNCTION(BlueprintCallable, Category = "System|Query")
+    void UpdateNodeLocation(AInteractiveNode* Node);
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AItemNode*> FindNodesWithCapability(TSubclassOf<UItemCapability> CapabilityClass) const;
 
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> GetAllNodes() const;
+
+    // 按NodeID索引的已注册节点，每次调用由句柄表构建一份拷贝
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Registry")
+    TMap<FString, AInteractiveNode*> GetNodeRegistry() const;
+
+    // 活动节点直接由Active状态桶提供
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|State")
+    TArray<AInteractiveNode*> GetActiveNodes() const { return GetNodesInState(ENodeState::Active); }
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    int32 GetNodeCountByState(ENodeState State) const { return GetNodesInState(State).Num(); }
+
+    // 原生调用方使用，直接引用状态桶，不拷贝
+    const TArray<AInteractiveNode*>& GetNodesInState(ENodeState State) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    int32 GetRegisteredNodeCount() const { return NodeIDTable.Num(); }
+
+    // 句柄查询
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    FNodeHandle FindNodeHandle(const FString& NodeID) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    AInteractiveNode* GetNodeByHandle(const FNodeHandle& Handle) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    bool IsNodeHandleValid(const FNodeHandle& Handle) const;
+
+    // 使用调用方缓存的句柄解析节点，句柄过期时按ID重新查找并刷新缓存
+    AInteractiveNode* ResolveNode(const FString& NodeID, FNodeHandle& InOutHandle) const;
+
     //玩家与节点交互
     UFUNCTION(BlueprintCallable, Category = "System|Interaction")
     void BindPlayerInteractionEvents();
@@ -255,16 +599,23 @@ public:
     UFUNCTION(BlueprintCallable, Category = "System|Connections")
     bool RemoveConnection(ANodeConnection* Connection);
 
+    // 批量移除：索引逐条摘除，槽位和活动连接数组各压缩一次，连接Actor分帧销毁
+    UFUNCTION(BlueprintCallable, Category = "System|Connections")
+    int32 RemoveConnections(const TArray<ANodeConnection*>& Connections);
+
     UFUNCTION(BlueprintCallable, Category = "System|Connections")
     int32 RemoveConnectionsBetween(const FString& NodeA, const FString& NodeB);
 
     UFUNCTION(BlueprintCallable, Category = "System|Connections")
     int32 RemoveAllConnectionsForNode(const FString& NodeID);
 
-    // 连接查询
+    // 连接查询（不限关系类型时返回枚举值最小的那条）
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     ANodeConnection* GetConnection(const FString& SourceID, const FString& TargetID) const;
 
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    ANodeConnection* GetConnectionOfType(const FString& SourceID, const FString& TargetID, ENodeRelationType RelationType) const;
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<ANodeConnection*> GetConnectionsForNode(const FString& NodeID) const;
 
@@ -277,6 +628,43 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AInteractiveNode*> GetConnectedNodes(const FString& NodeID, ENodeRelationType RelationType = ENodeRelationType::Dependency) const;
 
+    // 基于句柄的连接接口
+    UFUNCTION(BlueprintCallable, Category = "System|Handles")
+    ANodeConnection* CreateConnectionByHandle(const FNodeHandle& Source, const FNodeHandle& Target, ENodeRelationType Type);
+
+    UFUNCTION(BlueprintCallable, Category = "System|Handles")
+    int32 RemoveAllConnectionsForHandle(const FNodeHandle& Handle);
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    ANodeConnection* GetConnectionByHandle(const FNodeHandle& Source, const FNodeHandle& Target) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    ANodeConnection* GetConnectionOfTypeByHandle(const FNodeHandle& Source, const FNodeHandle& Target, ENodeRelationType RelationType) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    TArray<ANodeConnection*> GetConnectionsForHandle(const FNodeHandle& Handle) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    TArray<ANodeConnection*> GetOutgoingConnectionsForHandle(const FNodeHandle& Handle) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    TArray<ANodeConnection*> GetIncomingConnectionsForHandle(const FNodeHandle& Handle) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Handles")
+    TArray<AInteractiveNode*> GetConnectedNodesByHandle(const FNodeHandle& Handle, ENodeRelationType RelationType = ENodeRelationType::Dependency) const;
+
+    // 原生零拷贝访问（视图在注册表下一次修改前有效；遍历中可能改动图的调用方应先拷贝）
+    TConstArrayView<AInteractiveNode*> GetNodesByTypeView(ENodeType Type) const;
+    TConstArrayView<ANodeConnection*> GetConnectionsView(const FNodeHandle& Handle) const;
+
+    // 返回与当前图版本一致的邻接快照（必要时重建），供寻路和图分析按槽位索引遍历；单节点邻居查询直接用槽位连接表
+    const FNodeAdjacencySnapshot& GetAdjacencySnapshot() const;
+
+    // 访问器返回false时停止遍历
+    void ForEachOutgoingConnection(const FNodeHandle& Handle, TFunctionRef<bool(ANodeConnection*)> Visitor) const;
+    void ForEachIncomingConnection(const FNodeHandle& Handle, TFunctionRef<bool(ANodeConnection*)> Visitor) const;
+    void ForEachConnectedNode(const FNodeHandle& Handle, TFunctionRef<bool(AInteractiveNode*, ANodeConnection*)> Visitor) const;
+
     // 场景管理
     UFUNCTION(BlueprintCallable, Category = "System|Scene")
     bool SetActiveScene(ASceneNode* Scene);
@@ -304,12 +692,93 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AInteractiveNode*> ExecuteNodeQuery(const FNodeQueryParams& QueryParams) const;
 
+    // 编译一次，多次执行
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    FCompiledNodeQuery CompileNodeQuery(const FNodeQueryParams& QueryParams) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> ExecuteCompiledNodeQuery(const FCompiledNodeQuery& Query) const;
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AInteractiveNode*> FindPath(AInteractiveNode* Start, AInteractiveNode* End) const;
 
+    // 加权寻路：Dijkstra / A* / 双向搜索，支持关系类型过滤、方向规则和代价上限
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    FNodePathResult FindWeightedPath(AInteractiveNode* Start, AInteractiveNode* End, const FNodePathQuery& Query) const;
+
+    // 分析Prerequisite/Dependency/Sequence关系图：强连通分量、拓扑解锁顺序和每个节点的解锁层级
+    // 按CyclePolicy报告或打断环，返回发现的环数；场景关系批量建立后调用一次
+    UFUNCTION(BlueprintCallable, Category = "System|Query")
+    int32 AnalyzeRelationGraph();
+
+    // 最近一次分析的解锁层级，没有门控前驱为0
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    int32 GetUnlockRank(AInteractiveNode* Node) const;
+
+    // 最近一次分析的拓扑解锁顺序
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> GetUnlockOrder() const;
+
+    // 连通分量（忽略方向），分量下标在下一次注册/连接变化前稳定
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    int32 GetNodeComponentCount() const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    int32 GetNodeComponentIndex(AInteractiveNode* Node) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    TArray<AInteractiveNode*> GetComponentNodes(AInteractiveNode* Node) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
+    bool AreNodesConnected(AInteractiveNode* NodeA, AInteractiveNode* NodeB) const;
+
+    const FNodeComponentIndex& GetNodeComponents() const;
+
+    // 每个分量一个并行任务，参数为(分量下标, 槽位列表)
+    // 任务只能读取，不能修改节点/连接或广播事件；修改应收集后回到游戏线程提交
+    void ParallelForEachComponent(TFunctionRef<void(int32, TConstArrayView<int32>)> Task) const;
+
+    // 以RootNode为根的先序子树（含自身）
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Query")
     TArray<AInteractiveNode*> GetNodeHierarchy(AInteractiveNode* RootNode) const;
 
+    // 层级查询：Parent连接优先于场景子节点关系
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Hierarchy")
+    AInteractiveNode* GetHierarchyParent(AInteractiveNode* Node) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Hierarchy")
+    TArray<AInteractiveNode*> GetHierarchyChildren(AInteractiveNode* Node) const;
+
+    // 由近到远
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Hierarchy")
+    TArray<AInteractiveNode*> GetHierarchyAncestors(AInteractiveNode* Node) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Hierarchy")
+    AInteractiveNode* GetHierarchyRoot(AInteractiveNode* Node) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Hierarchy")
+    bool IsHierarchyAncestor(AInteractiveNode* Ancestor, AInteractiveNode* Node) const;
+
+    // 同步节点的场景父关系（节点的OnOwningSceneChanged会自动调用）
+    UFUNCTION(BlueprintCallable, Category = "System|Hierarchy")
+    void UpdateNodeHierarchy(AInteractiveNode* Node);
+
+    // 状态传播：请求入队，同一节点的重复请求合并，在Tick中按解锁层级和帧预算应用
+    // 返回false表示本轮级联中该节点已进入过该状态（防止环上来回传播）
+    UFUNCTION(BlueprintCallable, Category = "System|Propagation")
+    bool RequestNodeState(AInteractiveNode* Node, ENodeState NewState, AInteractiveNode* CauseNode = nullptr, ANodeConnection* CauseConnection = nullptr);
+
+    // 同步排空工作表（含期间新产生的请求），返回实际改变状态的节点数
+    UFUNCTION(BlueprintCallable, Category = "System|Propagation")
+    int32 FlushStatePropagation();
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "System|Propagation")
+    int32 GetPendingStateChangeCount() const { return StatePropagator.Num(); }
+
+    // 自动条件检查登记：StateCapability在BeginPlay/EndPlay中登记和注销，管理器只遍历登记表
+    void RegisterStateCheck(UStateCapability* Capability);
+    void UnregisterStateCheck(UStateCapability* Capability);
+
     // 系统管理
     UFUNCTION(BlueprintCallable, Category = "System|Management")
     bool SaveSystemState(const FString& SaveName);
@@ -344,16 +813,90 @@ protected:
     void CleanupInvalidReferences();
     void PropagateSystemEvent(const FGameEventData& EventData);
     bool CheckPrerequisites(AInteractiveNode* Node) const;
-    void ActivateDependentNodes(AInteractiveNode* CompletedNode);
+
+    // BudgetSeconds<=0时不限时间
+    int32 DrainStatePropagation(double BudgetSeconds);
+
+    // 并行检查登记表中到期的StateCapability条件（只读），结果在游戏线程提交
+    void EvaluateStateConditions();
+
+    // 源节点进入/离开完成状态时调整下游计数，计数归零的锁定节点被解锁；
+    // 源节点完成时，Dependency出边上前置已满足的锁定目标同样被解锁
+    void UpdateDependentPrerequisites(AInteractiveNode* SourceNode, bool bSourceCompleted);
+
+    // 门控关系：源节点完成前目标节点保持锁定，与CheckPrerequisites原有语义一致只有Prerequisite
+    static bool IsGatingRelation(ENodeRelationType Type);
+
+    // 环检测和解锁层级分析的关系类型：门控关系加上同样会传播状态的Dependency/Sequence
+    static uint32 GetGatingRelationMask();
+    void AddPrerequisiteEdge(ANodeConnection* Connection, const FNodeHandle& TargetHandle);
+    void RemovePrerequisiteEdge(ANodeConnection* Connection, const FNodeHandle& TargetHandle);
 
     // 辅助方法
+    AInteractiveNode* SpawnNodeFromData(TSubclassOf<AInteractiveNode> NodeClass, const FNodeGenerateData& GenerateData);
+    void ApplyGeneratedCapabilities(AItemNode* ItemNode, const TArray<FCapabilityData>& Capabilities);
+
+    // 写入槽位、ID表、各索引并绑定事件，不广播也不打印日志
+    void AddNodeToRegistry(AInteractiveNode* Node, const FString& NodeID);
+
+    // ID非空、未注册且未在本批次出现时返回true，并记入BatchIDs
+    bool IsNewNodeID(const FString& NodeID, TSet<FString>& BatchIDs) const;
+
+    // 不修改任何状态，返回第一条错误；通过时为空
+    FString ValidateGraphDelta(const FNodeGraphDelta& Delta) const;
+    TSubclassOf<AInteractiveNode> ResolveGeneratedNodeClass(const FNodeGenerateData& GenerateData) const;
+
+    // 撤销未提交增量已新增的连接和节点
+    void RollbackGraphDelta(const TArray<ANodeConnection*>& CreatedConnections, const TArray<AInteractiveNode*>& CreatedNodes);
+    void ApplyNodePropertyDelta(AInteractiveNode* Node, const FNodePropertyDelta& PropertyDelta);
+
     void RegisterNodeEvents(AInteractiveNode* Node);
     void UnregisterNodeEvents(AInteractiveNode* Node);
     void RegisterConnectionEvents(ANodeConnection* Connection);
     void UnregisterConnectionEvents(ANodeConnection* Connection);
     void UpdateNodeTypeMap(AInteractiveNode* Node, bool bAdd);
     void UpdateNodeTagMap(AInteractiveNode* Node, bool bAdd);
-    
+
+    void MarkGraphDirty() { ++GraphVersion; }
+
+    // 连接哈希索引维护
+    void AddToEdgeIndex(ANodeConnection* Connection, const FNodeHandle& Source, const FNodeHandle& Target);
+
+    // 摘除连接的哈希索引、前置计数和层级记录（槽位数组由调用方处理）
+    void DetachConnectionIndices(ANodeConnection* Connection);
+
+    // 节点移动后标记其连接的变换为脏，在Tick中统一更新：并行计算变换，再批量写入
+    void MarkConnectionTransformsDirty(const FNodeHandle& Handle);
+    void UpdateDirtyConnectionTransforms();
+
+    // 先评估相机附近的节点，再轮转评估其余节点，直到预算用完
+    void UpdateSignificance(double BudgetSeconds);
+    void EvaluateNodeSignificance(int32 SlotIndex, const FVector& ViewLocation, const FConvexVolume& ViewFrustum, const FNodeSignificanceSettings& Settings);
+
+    // 无当前场景、节点不在任何层级中，或位于当前场景的子树内时返回true
+    bool IsSlotInActiveScene(int32 SlotIndex) const;
+
+    // 连接层级取两端节点中较高的一个
+    void ApplyConnectionSignificance(ANodeConnection* Connection);
+
+    // 已移除的连接先隐藏，在Tick中按每帧上限销毁；MaxCount<=0时全部销毁
+    void QueueConnectionDestroy(ANodeConnection* Connection);
+    void ProcessPendingConnectionDestroys(int32 MaxCount);
+    void RemoveFromEdgeIndex(ANodeConnection* Connection);
+
+    TArray<AInteractiveNode*> GetNodesFromSlots(const TArray<int32>& SlotIndices) const;
+
+    // 状态桶维护（O(1)交换删除）
+    void AddToStateBucket(AInteractiveNode* Node);
+    void RemoveFromStateBucket(AInteractiveNode* Node);
+
+    // 槽位管理
+    FNodeHandle AllocateNodeSlot(AInteractiveNode* Node, const FString& NodeID);
+    void ReleaseNodeSlot(const FNodeHandle& Handle);
+    FNodeSlot* FindNodeSlot(const FNodeHandle& Handle);
+    const FNodeSlot* FindNodeSlot(const FNodeHandle& Handle) const;
+    FNodeHandle GetRegisteredHandle(const AInteractiveNode* Node) const;
+
     FVector CalculateNodeSpawnLocation(const FVector& BaseLocation) const;
     
 private:
@@ -361,6 +904,27 @@ private:
     FTimerHandle GenerationTimerHandle;
     FTimerHandle ValidationTimerHandle;
 
+    // 空闲槽位
+    TArray<int32> FreeNodeSlots;
+
+    bool bIsDrainingStates;
+
+    double NextConditionEvaluationTime;
+
+    // 应用图增量期间为true，逐项事件不广播
+    bool bIsApplyingGraphDelta;
+
+    UPROPERTY(Transient)
+    TArray<ANodeConnection*> PendingConnectionDestroys;
+
+    // 登记了自动条件检查的StateCapability，能力记录自己的下标以便O(1)注销
+    UPROPERTY(Transient)
+    TArray<UStateCapability*> StateCheckCapabilities;
+
+    // 端点移动过的连接，每个连接最多出现一次（以连接上的脏标记去重）
+    UPROPERTY(Transient)
+    TArray<ANodeConnection*> DirtyConnectionTransforms;
+
     // 场景过渡
     bool bIsTransitioning;
     float TransitionProgress;
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// NodeUIVisibilityService.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Core/NodeDataTypes.h"
+#include "NodeUIVisibilityService.generated.h"
+
+// 前向声明
+class ANodeSystemManager;
+class AInteractiveNode;
+class APlayerController;
+
+// 节点信息UI的统一可见性判断，由NodeSystemManager持有并在Tick中调用，取代每个节点自己的定时器
+// - 一轮扫描 = 空间索引中玩家附近的节点 + 当前已显示的节点 + 常显UI的节点，按时间预算分帧评估
+// - 判断仍走节点的ShouldShowUI，已显示的节点按UIHideDistanceScale放宽距离（滞回）
+// - 只在显示状态变化时调用节点的ShowNodeUI/HideNodeUI；低于Full显著性层级的节点不显示
+UCLASS(ClassGroup = (Nodes))
+class MYPROJECT_API UNodeUIVisibilityService : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UNodeUIVisibilityService();
+
+    // 每帧评估的时间预算（毫秒），每帧至少评估一个节点
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UI", meta = (ClampMin = "0.0"))
+    float BudgetMs;
+
+    // 两轮扫描开始的最小间隔（秒）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UI", meta = (ClampMin = "0.0"))
+    float MinSweepInterval;
+
+    void Update(const ANodeSystemManager& Manager);
+
+private:
+    void BeginSweep(const ANodeSystemManager& Manager, const FVector& ViewerLocation);
+
+    // 查询半径和常显节点只在图版本变化后重新收集
+    void RefreshCandidates(const ANodeSystemManager& Manager);
+
+    void EvaluateNode(const ANodeSystemManager& Manager, const FNodeHandle& Handle, APlayerController* Player);
+
+    static AInteractiveNode* ResolveNode(const ANodeSystemManager& Manager, const FNodeHandle& Handle);
+
+    TArray<FNodeHandle> SweepHandles;
+    int32 SweepCursor;
+    double LastSweepTime;
+
+    // 由本服务显示的节点，离开查询半径后仍需评估以便隐藏
+    TArray<FNodeHandle> ShownHandles;
+
+    TArray<FNodeHandle> AlwaysShownHandles;
+    float QueryRadius;
+    uint32 CandidatesGraphVersion;
+};
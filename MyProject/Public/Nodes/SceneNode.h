@@ -60,6 +60,9 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Scene|Children")
     TArray<AInteractiveNode*> GetAllChildNodes() const { return ChildNodes; }
 
+    // 原生调用方使用，不拷贝
+    TConstArrayView<AInteractiveNode*> GetChildNodesView() const { return ChildNodes; }
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Scene|Children")
     TArray<AInteractiveNode*> GetChildNodesByType(ENodeType Type) const;
 